@@ -8,6 +8,9 @@ template = env.get_template("generated.cpp.j2")
 
 counting_sketch_names = ["CPC", "HLL"]
 
+# Quantile sketches that also have a (k, value, weight) aggregate.
+weighted_sketch_names = ["KLL", "TDigest"]
+
 logical_type_mapping = {
     "LogicalType::BOOLEAN": "bool",
     "LogicalType::TINYINT": "int8_t",
@@ -66,17 +69,69 @@ def get_sketch_class_name(sketch_type: str):
     return f"datasketches::{sketch_type.lower()}_sketch"
 
 
+def get_state_sketch_class_name(sketch_type: str):
+    # The aggregate states keep their KLL, REQ and TDigest sketches in the aggregate's
+    # arena, the classic quantiles and distinct counting sketches in DuckDB's buffer
+    # allocator.
+    if sketch_type == "TDigest":
+        return "datasketches::tdigest<T, DSArenaAllocator<T>>"
+    if sketch_type in counting_sketch_names:
+        return f"datasketches::{sketch_type.lower()}_sketch_alloc<DSBufferAllocator<uint8_t>>"
+    if sketch_type == "Quantiles":
+        return "datasketches::quantiles_sketch<T, std::less<T>, DSBufferAllocator<T>>"
+    return f"datasketches::{sketch_type.lower()}_sketch<T, std::less<T>, DSArenaAllocator<T>>"
+
+
+def get_state_union_class_name(sketch_type: str):
+    return f"datasketches::{sketch_type.lower()}_union_alloc<DSBufferAllocator<uint8_t>>"
+
+
+# Readers of the preamble of a stored sketch, see datasketches_serialized.hpp.
+header_readers = {
+    "Quantiles": ("DSQuantilesHeader", "DSQuantilesReadHeader<T>"),
+    "KLL": ("DSKLLHeader", "DSKLLReadHeader<T>"),
+    "REQ": ("DSREQHeader", "DSREQReadHeader<T>"),
+    "TDigest": ("DSTDigestHeader", "DSTDigestReadHeader"),
+    "HLL": ("DSHLLHeader", "DSHLLReadHeader"),
+    "CPC": ("DSCPCHeader", "DSCPCReadHeader"),
+}
+
+
 def unary_functions_per_sketch_type(sketch_type: str):
     if sketch_type not in counting_sketch_names:
-        deserialize_sketch = f"auto sketch = {get_sketch_class_name(sketch_type)}<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize());"
+        sketch_class = f"{get_sketch_class_name(sketch_type)}<T>"
     else:
-        deserialize_sketch = f"auto sketch = {get_sketch_class_name(sketch_type)}::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize());"
+        sketch_class = get_sketch_class_name(sketch_type)
+
+    # Functions that read a field of the preamble answer from the bytes of the sketch
+    # and only deserialize it when the reader can't tell, known names the flag of a
+    # field that is not always in the preamble.
+    def from_header(field: str, known: str = None):
+        header_type, reader = header_readers[sketch_type]
+        return {"type": header_type, "reader": reader, "field": field, "known": known}
+
+    # A constant sketch is deserialized by the first row that uses it and then kept
+    # for the rest of the chunk.
+    sketch_pre_executor = f"""
+                    const bool sketch_is_constant = sketch_vector.GetVectorType() == VectorType::CONSTANT_VECTOR;
+                    std::optional<{sketch_class}> constant_sketch;
+                    """
+    deserialize_sketch = f"""
+                    std::optional<{sketch_class}> row_sketch;
+                    auto &sketch_holder = sketch_is_constant ? constant_sketch : row_sketch;
+                    if (!sketch_holder)
+                    {{
+                        sketch_holder.emplace({sketch_class}::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize()));
+                    }}
+                    auto &sketch = *sketch_holder;
+                    """
 
     if sketch_type in counting_sketch_names:
         sketch_argument = {
             "cpp_type": "string_t",
             "duckdb_type": lambda contained_type: "sketch_type",
             "name": "sketch",
+            "pre_executor": sketch_pre_executor,
             "process": deserialize_sketch,
         }
     else:
@@ -84,6 +139,7 @@ def unary_functions_per_sketch_type(sketch_type: str):
             "cpp_type": "string_t",
             "duckdb_type": lambda contained_type: f"sketch_map_types[{contained_type.replace('LogicalType', 'LogicalTypeId')}]",
             "name": "sketch",
+            "pre_executor": sketch_pre_executor,
             "process": deserialize_sketch,
         }
 
@@ -118,6 +174,7 @@ def unary_functions_per_sketch_type(sketch_type: str):
     result = [
         {
             "method": "return sketch.is_empty();",
+            "header": from_header("empty"),
             "name": "is_empty",
             "description": "Return a boolean indicating if the sketch is empty",
             "example": f"datasketch_{sketch_type.lower()}_is_empty(sketch)",
@@ -133,6 +190,7 @@ def unary_functions_per_sketch_type(sketch_type: str):
             [
                 {
                     "method": "return sketch.get_k();",
+                    "header": from_header("k"),
                     "arguments": [sketch_argument],
                     "name": "k",
                     "description": "Return the value of K for this sketch",
@@ -250,6 +308,7 @@ def unary_functions_per_sketch_type(sketch_type: str):
                 },
                 {
                     "method": "return sketch.get_lg_config_k();",
+                    "header": from_header("lg_config_k"),
                     "description": "Return the value of log base 2 K for this sketch",
                     "example": f"datasketch_{sketch_type.lower()}_lg_config_k(sketch)",
                     "arguments": [
@@ -260,6 +319,7 @@ def unary_functions_per_sketch_type(sketch_type: str):
                 },
                 {
                     "method": "return sketch.is_compact();",
+                    "header": from_header("compact"),
                     "description": "Return whether the sketch is in compact form",
                     "example": f"datasketch_{sketch_type.lower()}_is_compact(sketch)",
                     "arguments": [
@@ -290,6 +350,7 @@ def unary_functions_per_sketch_type(sketch_type: str):
             [
                 {
                     "method": "return sketch.get_estimate();",
+                    "header": from_header("estimate", "has_estimate") if sketch_type == "HLL" else None,
                     "description": "Return the estimate of the number of distinct items seen by the sketch",
                     "example": f"datasketch_{sketch_type.lower()}_estimate(sketch)",
                     "arguments": [
@@ -364,6 +425,7 @@ def unary_functions_per_sketch_type(sketch_type: str):
                     "description": "Return the total weight of this sketch",
                     "example": f"datasketch_{sketch_type.lower()}_total_weight(sketch)",
                     "method": "return sketch.get_total_weight();",
+                    "header": from_header("total_weight", "has_total_weight"),
                     "name": "total_weight",
                     "arguments": [
                         sketch_argument,
@@ -468,6 +530,7 @@ def unary_functions_per_sketch_type(sketch_type: str):
                     "description": "Return the number of items contained in the sketch",
                     "example": f"datasketch_{sketch_type.lower()}_rank(sketch)",
                     "method": "return sketch.get_n();",
+                    "header": from_header("n", "has_n" if sketch_type == "REQ" else None),
                     "name": "n",
                     "arguments": [
                         sketch_argument,
@@ -478,6 +541,7 @@ def unary_functions_per_sketch_type(sketch_type: str):
                     "description": "Return a boolean indicating if the sketch is in estimation mode",
                     "example": f"datasketch_{sketch_type.lower()}_is_estimation_mode(sketch)",
                     "method": "return sketch.is_estimation_mode();",
+                    "header": from_header("estimation_mode"),
                     "name": "is_estimation_mode",
                     "arguments": [
                         sketch_argument,
@@ -488,6 +552,7 @@ def unary_functions_per_sketch_type(sketch_type: str):
                     "description": "Return the number of retained items in the sketch",
                     "example": f"datasketch_{sketch_type.lower()}_num_retained(sketch)",
                     "method": "return sketch.get_num_retained();",
+                    "header": from_header("num_retained", "has_num_retained" if sketch_type == "REQ" else None),
                     "name": "num_retained",
                     "arguments": [
                         sketch_argument,
@@ -575,6 +640,26 @@ def get_function_block(function_info: Any) -> str:
     lambda_args = []
     lambda_lines = []
     pre_executor_lines = []
+    lambda_return_type = ""
+
+    header = function_info.get("header")
+    if header:
+        condition = f"{header['reader']}(sketch_data.GetDataUnsafe(), sketch_data.GetSize(), header)"
+        if header["known"]:
+            condition += f" && header.{header['known']}"
+        lambda_lines.append(
+            f"""
+                    {{
+                        {header['type']} header;
+                        if ({condition})
+                        {{
+                            return header.{header['field']};
+                        }}
+                    }}
+                    """
+        )
+        # The field and the library's getter may differ in their integer type.
+        lambda_return_type = f" -> {cpp_types[-1]}"
 
     for argument in function_info["arguments"]:
         executor_args.append(f"{argument['name']}_vector")
@@ -607,7 +692,7 @@ def get_function_block(function_info: Any) -> str:
         <{joined_cpp_types}>
         (
         {joined_executor_args},
-        [&]({joined_lambda_args}) {{
+        [&]({joined_lambda_args}){lambda_return_type} {{
 
             {lambda_body}
         }});"""
@@ -618,7 +703,10 @@ def get_function_block(function_info: Any) -> str:
 # Data to render the template
 data = {
     "sketch_class_name": get_sketch_class_name,
+    "state_sketch_class_name": get_state_sketch_class_name,
+    "state_union_class_name": get_state_union_class_name,
     "counting_sketch_names": counting_sketch_names,
+    "weighted_sketch_names": weighted_sketch_names,
     #    "function_names_per_sketch": get_sketch_function_names,
     "sketch_types": ["Quantiles", "KLL", "REQ", "TDigest", "HLL", "CPC"],
     "logical_type_to_cplusplus_type": sketch_type_to_allowed_logical_types,
@@ -4,6 +4,8 @@
 #include "duckdb/parser/parsed_data/create_scalar_function_info.hpp"
 #include "duckdb/parser/parsed_data/create_aggregate_function_info.hpp"
 #include "duckdb/function/scalar_function.hpp"
+#include "duckdb/common/string_util.hpp"
+#include "duckdb/main/config.hpp"
 
 #include <DataSketches/quantiles_sketch.hpp>
 #include <DataSketches/kll_sketch.hpp>
@@ -13,6 +15,17 @@
 #include <DataSketches/cpc_sketch.hpp>
 #include <DataSketches/cpc_union.hpp>
 
+#include "datasketches_allocator.hpp"
+#include "datasketches_serialized.hpp"
+
+#include <algorithm>
+#include <bitset>
+#include <cmath>
+#include <cstring>
+#include <optional>
+#include <ostream>
+#include <streambuf>
+
 using namespace duckdb;
 namespace duckdb_datasketches
 {
@@ -26,6 +39,13 @@ static std::string toLowerCase(const std::string& input) {
     return result;
 }
 
+// Number of values the state of a create aggregate keeps by itself before the sketch
+// is built. Most groups of a GROUP BY over many keys never see more than that.
+static constexpr idx_t DS_SMALL_BUFFER_SIZE = 8;
+
+// Largest weight of a weighted item that is added to a sketch one copy at a time.
+static constexpr uint64_t DS_MAX_REPEATED_WEIGHT = 16;
+
     
 
 
@@ -34,20 +54,29 @@ struct DSQuantilesBindData : public FunctionData {
 	}
 	explicit DSQuantilesBindData(int32_t k) : k(k) {
 	}
+    
 
 	unique_ptr<FunctionData> Copy() const override {
+    
 		return make_uniq<DSQuantilesBindData>(k);
+    
 	}
 
 	bool Equals(const FunctionData &other_p) const override {
 		auto &other = other_p.Cast<DSQuantilesBindData>();
+    
         return k == other.k;
+    
 	}
 
     int32_t k;
+    
 };
 
+    
+
 
+    
 unique_ptr<FunctionData> DSQuantilesBind(ClientContext &context, AggregateFunction &function,
                                             vector<unique_ptr<Expression>> &arguments) {
 	if (arguments[0]->HasParameter()) {
@@ -63,8 +92,10 @@ unique_ptr<FunctionData> DSQuantilesBind(ClientContext &context, AggregateFuncti
 
 	auto actual_k = k_val.GetValue<int32_t>();
 
+    
 	Function::EraseArgument(function, arguments, 0);
 	return make_uniq<DSQuantilesBindData>(actual_k);
+    
 }
 
 
@@ -73,42 +104,194 @@ unique_ptr<FunctionData> DSQuantilesBind(ClientContext &context, AggregateFuncti
     
     struct DSQuantilesState
     {
+        using SketchType = datasketches::quantiles_sketch<T, std::less<T>, DSBufferAllocator<T>>;
+        
+        using AllocatorType = DSBufferAllocator<T>;
+        
+
+        // The sketches are kept inside the state and constructed with the first value.
+        
+        // Their buffers come from DuckDB's buffer allocator: merging into an empty or
+        // exact sketch copies the source with the source's allocator and keeps it,
+        // so the sketch of a combine target could otherwise take blocks from the
+        // arena of a source state on another thread.
+        
+        DSArenaPool *pool = nullptr;
+        DSInline<SketchType> sketch;
         
-        datasketches::quantiles_sketch<T> *sketch = nullptr;
         
+        
+        // The items added before the sketch is built, in the order they were added.
+        // Once the sketch exists the buffer is empty.
+        T small_items[DS_SMALL_BUFFER_SIZE];
+        
+        uint8_t small_count = 0;
 
         ~DSQuantilesState()
         {
-            if (sketch)
+            // The arena releases the memory of its blocks in bulk, the destructors only
+            // give back buffers that came from the heap or the buffer allocator.
+            if (pool)
             {
-                delete sketch;
+                pool->Release();
             }
+            sketch.Destroy();
+            
         }
 
         
-        void CreateSketch(int32_t k)
+        AllocatorType GetAllocator(ArenaAllocator &arena)
         {
-            D_ASSERT(!sketch);
+            return AllocatorType(&arena.GetAllocator());
+        }
+        
+        
+
+        
+        static SketchType NewSketch(int32_t k, const AllocatorType &allocator)
+        {
+            
             D_ASSERT(k > 0);
             D_ASSERT(k <= 32768);
-            sketch = new datasketches::quantiles_sketch<T>(k);
+            return SketchType(k, std::less<T>(), allocator);
+            
         }
+
+        void CreateSketch(int32_t k, ArenaAllocator &arena)
+        {
+            D_ASSERT(!sketch);
+            sketch.Construct(NewSketch(k, GetAllocator(arena)));
+            FlushSmallBuffer();
+        }
+
+        // A sketch of the buffered values alone, used to finalize a group that never
+        // built its own. It is short lived and uses the heap, a sketch in the arena
+        // would stay there until the whole aggregate is destroyed.
+        SketchType SmallBufferSketch(int32_t k) const
+        {
+            auto result = NewSketch(k, AllocatorType());
+            ReplaySmallBuffer(result);
+            return result;
+        }
+
         
+        // Copy the sketch of a state that is kept after the combine. Other threads may
+        // combine the same state at the same time, so it is only read: the copy is an
+        // empty sketch of this state that the existing one is merged into.
+        void CreateSketch(const DSQuantilesState &existing, ArenaAllocator &arena)
+        {
+            D_ASSERT(!sketch);
+            if (existing.sketch)
+            {
+                sketch.Construct(NewSketch(existing.sketch->get_k(), GetAllocator(arena)));
+                sketch->merge(*existing.sketch);
+                FlushSmallBuffer();
+            }
+        }
 
-        void CreateSketch(const DSQuantilesState &existing)
+        
+        // Take over the sketches of a state that is discarded after the combine. Their
+        // memory stays in the other arena, which lives as long as this one, and
+        // further buffers are taken from this state's arena.
+        void MoveFrom(DSQuantilesState &existing, ArenaAllocator &arena)
         {
+            D_ASSERT(!pool);
+            std::swap(pool, existing.pool);
+            if (pool)
+            {
+                pool->SetArena(arena);
+            }
+            D_ASSERT(!sketch);
             if (existing.sketch)
             {
-                
-                sketch = new datasketches::quantiles_sketch<T>(*existing.sketch);
-                
+                sketch.Construct(std::move(*existing.sketch));
+                existing.sketch.Destroy();
+                FlushSmallBuffer();
+            }
+            
+            
+        }
+
+        
+        // Add an item, the sketch is only built once the buffer is full.
+        void Update(const T &item, int32_t k, ArenaAllocator &arena)
+        {
+            if (!sketch)
+            {
+                if (small_count < DS_SMALL_BUFFER_SIZE)
+                {
+                    small_items[small_count++] = item;
+                    return;
+                }
+                CreateSketch(k, arena);
+            }
+            sketch->update(item);
+        }
+
+        void ReplaySmallBuffer(SketchType &target) const
+        {
+            for (idx_t i = 0; i < small_count; i++)
+            {
+                target.update(small_items[i]);
+            }
+        }
+
+        // Merge a sketch into the state's sketch as if it was merged count times. It
+        // is merged once, as a sketch built from the powers of two in count, each one
+        // the previous merged with itself.
+        void MergeRepeated(SketchType power, uint64_t count, int32_t k)
+        {
+            D_ASSERT(sketch);
+            auto repeated = NewSketch(k, AllocatorType());
+            while (true)
+            {
+                if (count & 1)
+                {
+                    repeated.merge(power);
+                }
+                count >>= 1;
+                if (count == 0)
+                {
+                    break;
+                }
+                power.merge(SketchType(power));
             }
+            sketch->merge(repeated);
+        }
+        
+        
+
+        void FlushSmallBuffer()
+        {
+            D_ASSERT(sketch);
+            ReplaySmallBuffer(*sketch);
+            small_count = 0;
         }
 
         
-        datasketches::quantiles_sketch<T> deserialize_sketch(const string_t &data)
+        
+
+        
+        // Deserialized sketches are short lived and use the heap.
+        static SketchType deserialize_sketch(const string_t &data)
+        {
+            
+            return SketchType::deserialize(data.GetDataUnsafe(), data.GetSize(), datasketches::serde<T>(), std::less<T>(),
+                                           AllocatorType());
+            
+        }
+
+        // Merge a serialized sketch into the state's sketch.
+        void MergeSerialized(const string_t &data)
         {
-            return datasketches::quantiles_sketch<T>::deserialize(data.GetDataUnsafe(), data.GetSize());
+            
+            // Sketches that are not in estimation mode are read in place.
+            if (DSQuantilesUpdateFromExact<T>(*sketch, data.GetDataUnsafe(), data.GetSize()))
+            {
+                return;
+            }
+            
+            sketch->merge(deserialize_sketch(data));
         }
         
     };
@@ -143,20 +326,29 @@ struct DSKLLBindData : public FunctionData {
 	}
 	explicit DSKLLBindData(int32_t k) : k(k) {
 	}
+    
 
 	unique_ptr<FunctionData> Copy() const override {
+    
 		return make_uniq<DSKLLBindData>(k);
+    
 	}
 
 	bool Equals(const FunctionData &other_p) const override {
 		auto &other = other_p.Cast<DSKLLBindData>();
+    
         return k == other.k;
+    
 	}
 
     int32_t k;
+    
 };
 
+    
+
 
+    
 unique_ptr<FunctionData> DSKLLBind(ClientContext &context, AggregateFunction &function,
                                             vector<unique_ptr<Expression>> &arguments) {
 	if (arguments[0]->HasParameter()) {
@@ -172,8 +364,10 @@ unique_ptr<FunctionData> DSKLLBind(ClientContext &context, AggregateFunction &fu
 
 	auto actual_k = k_val.GetValue<int32_t>();
 
+    
 	Function::EraseArgument(function, arguments, 0);
 	return make_uniq<DSKLLBindData>(actual_k);
+    
 }
 
 
@@ -182,42 +376,218 @@ unique_ptr<FunctionData> DSKLLBind(ClientContext &context, AggregateFunction &fu
     
     struct DSKLLState
     {
+        using SketchType = datasketches::kll_sketch<T, std::less<T>, DSArenaAllocator<T>>;
         
-        datasketches::kll_sketch<T> *sketch = nullptr;
+        using AllocatorType = DSArenaAllocator<T>;
         
 
+        // The sketches are kept inside the state and constructed with the first value.
+        
+        // Their buffers live in the aggregate's arena and the pool is created with the
+        // first sketch.
+        
+        DSArenaPool *pool = nullptr;
+        DSInline<SketchType> sketch;
+        
+        
+        
+        // The items added before the sketch is built, in the order they were added.
+        // Once the sketch exists the buffer is empty.
+        T small_items[DS_SMALL_BUFFER_SIZE];
+        
+        uint8_t small_count = 0;
+
         ~DSKLLState()
         {
-            if (sketch)
+            // The arena releases the memory of its blocks in bulk, the destructors only
+            // give back buffers that came from the heap or the buffer allocator.
+            if (pool)
+            {
+                pool->Release();
+            }
+            sketch.Destroy();
+            
+        }
+
+        
+        AllocatorType GetAllocator(ArenaAllocator &arena)
+        {
+            if (!pool)
             {
-                delete sketch;
+                pool = DSArenaPool::Create(arena);
             }
+            return AllocatorType(pool);
         }
+        
 
         
-        void CreateSketch(int32_t k)
+        static SketchType NewSketch(int32_t k, const AllocatorType &allocator)
         {
-            D_ASSERT(!sketch);
+            
             D_ASSERT(k > 0);
             D_ASSERT(k <= 32768);
-            sketch = new datasketches::kll_sketch<T>(k);
+            return SketchType(k, std::less<T>(), allocator);
+            
+        }
+
+        void CreateSketch(int32_t k, ArenaAllocator &arena)
+        {
+            D_ASSERT(!sketch);
+            sketch.Construct(NewSketch(k, GetAllocator(arena)));
+            FlushSmallBuffer();
+        }
+
+        // A sketch of the buffered values alone, used to finalize a group that never
+        // built its own. It is short lived and uses the heap, a sketch in the arena
+        // would stay there until the whole aggregate is destroyed.
+        SketchType SmallBufferSketch(int32_t k) const
+        {
+            auto result = NewSketch(k, AllocatorType());
+            ReplaySmallBuffer(result);
+            return result;
         }
+
         
+        // Copy the sketch of a state that is kept after the combine. Other threads may
+        // combine the same state at the same time, so it is only read: the copy is an
+        // empty sketch of this state that the existing one is merged into.
+        void CreateSketch(const DSKLLState &existing, ArenaAllocator &arena)
+        {
+            D_ASSERT(!sketch);
+            if (existing.sketch)
+            {
+                sketch.Construct(NewSketch(existing.sketch->get_k(), GetAllocator(arena)));
+                sketch->merge(*existing.sketch);
+                FlushSmallBuffer();
+            }
+        }
 
-        void CreateSketch(const DSKLLState &existing)
+        
+        // Take over the sketches of a state that is discarded after the combine. Their
+        // memory stays in the other arena, which lives as long as this one, and
+        // further buffers are taken from this state's arena.
+        void MoveFrom(DSKLLState &existing, ArenaAllocator &arena)
         {
+            D_ASSERT(!pool);
+            std::swap(pool, existing.pool);
+            if (pool)
+            {
+                pool->SetArena(arena);
+            }
+            D_ASSERT(!sketch);
             if (existing.sketch)
             {
-                
-                sketch = new datasketches::kll_sketch<T>(*existing.sketch);
-                
+                sketch.Construct(std::move(*existing.sketch));
+                existing.sketch.Destroy();
+                FlushSmallBuffer();
+            }
+            
+            
+        }
+
+        
+        // Add an item, the sketch is only built once the buffer is full.
+        void Update(const T &item, int32_t k, ArenaAllocator &arena)
+        {
+            if (!sketch)
+            {
+                if (small_count < DS_SMALL_BUFFER_SIZE)
+                {
+                    small_items[small_count++] = item;
+                    return;
+                }
+                CreateSketch(k, arena);
+            }
+            sketch->update(item);
+        }
+
+        void ReplaySmallBuffer(SketchType &target) const
+        {
+            for (idx_t i = 0; i < small_count; i++)
+            {
+                target.update(small_items[i]);
+            }
+        }
+
+        // Merge a sketch into the state's sketch as if it was merged count times. It
+        // is merged once, as a sketch built from the powers of two in count, each one
+        // the previous merged with itself.
+        void MergeRepeated(SketchType power, uint64_t count, int32_t k)
+        {
+            D_ASSERT(sketch);
+            auto repeated = NewSketch(k, AllocatorType());
+            while (true)
+            {
+                if (count & 1)
+                {
+                    repeated.merge(power);
+                }
+                count >>= 1;
+                if (count == 0)
+                {
+                    break;
+                }
+                power.merge(SketchType(power));
+            }
+            sketch->merge(repeated);
+        }
+        
+
+        // Add an item as if it was added weight times. Larger weights are merged in
+        // as a sketch that holds the item once, repeated weight times. All of its
+        // items are the same, so the compactions lose nothing.
+        void UpdateWeighted(const T &item, uint64_t weight, int32_t k, ArenaAllocator &arena)
+        {
+            if (weight <= DS_MAX_REPEATED_WEIGHT)
+            {
+                for (uint64_t i = 0; i < weight; i++)
+                {
+                    Update(item, k, arena);
+                }
+                return;
+            }
+            if (!sketch)
+            {
+                CreateSketch(k, arena);
             }
+            auto single = NewSketch(k, AllocatorType());
+            single.update(item);
+            MergeRepeated(std::move(single), weight, k);
         }
+        
+        
+
+        void FlushSmallBuffer()
+        {
+            D_ASSERT(sketch);
+            ReplaySmallBuffer(*sketch);
+            small_count = 0;
+        }
+
+        
+        
 
         
-        datasketches::kll_sketch<T> deserialize_sketch(const string_t &data)
+        // Deserialized sketches are short lived and use the heap.
+        static SketchType deserialize_sketch(const string_t &data)
         {
-            return datasketches::kll_sketch<T>::deserialize(data.GetDataUnsafe(), data.GetSize());
+            
+            return SketchType::deserialize(data.GetDataUnsafe(), data.GetSize(), datasketches::serde<T>(), std::less<T>(),
+                                           AllocatorType());
+            
+        }
+
+        // Merge a serialized sketch into the state's sketch.
+        void MergeSerialized(const string_t &data)
+        {
+            
+            // Sketches that have not compacted yet are read in place.
+            if (DSKLLUpdateFromExact<T>(*sketch, data.GetDataUnsafe(), data.GetSize()))
+            {
+                return;
+            }
+            
+            sketch->merge(deserialize_sketch(data));
         }
         
     };
@@ -252,20 +622,29 @@ struct DSREQBindData : public FunctionData {
 	}
 	explicit DSREQBindData(int32_t k) : k(k) {
 	}
+    
 
 	unique_ptr<FunctionData> Copy() const override {
+    
 		return make_uniq<DSREQBindData>(k);
+    
 	}
 
 	bool Equals(const FunctionData &other_p) const override {
 		auto &other = other_p.Cast<DSREQBindData>();
+    
         return k == other.k;
+    
 	}
 
     int32_t k;
+    
 };
 
+    
+
 
+    
 unique_ptr<FunctionData> DSREQBind(ClientContext &context, AggregateFunction &function,
                                             vector<unique_ptr<Expression>> &arguments) {
 	if (arguments[0]->HasParameter()) {
@@ -281,8 +660,10 @@ unique_ptr<FunctionData> DSREQBind(ClientContext &context, AggregateFunction &fu
 
 	auto actual_k = k_val.GetValue<int32_t>();
 
+    
 	Function::EraseArgument(function, arguments, 0);
 	return make_uniq<DSREQBindData>(actual_k);
+    
 }
 
 
@@ -291,49 +672,196 @@ unique_ptr<FunctionData> DSREQBind(ClientContext &context, AggregateFunction &fu
     
     struct DSREQState
     {
+        using SketchType = datasketches::req_sketch<T, std::less<T>, DSArenaAllocator<T>>;
+        
+        using AllocatorType = DSArenaAllocator<T>;
+        
+
+        // The sketches are kept inside the state and constructed with the first value.
+        
+        // Their buffers live in the aggregate's arena and the pool is created with the
+        // first sketch.
         
-        datasketches::req_sketch<T> *sketch = nullptr;
+        DSArenaPool *pool = nullptr;
+        DSInline<SketchType> sketch;
         
+        
+        
+        // The items added before the sketch is built, in the order they were added.
+        // Once the sketch exists the buffer is empty.
+        T small_items[DS_SMALL_BUFFER_SIZE];
+        
+        uint8_t small_count = 0;
 
         ~DSREQState()
         {
-            if (sketch)
+            // The arena releases the memory of its blocks in bulk, the destructors only
+            // give back buffers that came from the heap or the buffer allocator.
+            if (pool)
             {
-                delete sketch;
+                pool->Release();
             }
+            sketch.Destroy();
+            
         }
 
         
-        void CreateSketch(int32_t k)
+        AllocatorType GetAllocator(ArenaAllocator &arena)
         {
-            D_ASSERT(!sketch);
+            if (!pool)
+            {
+                pool = DSArenaPool::Create(arena);
+            }
+            return AllocatorType(pool);
+        }
+        
+
+        
+        static SketchType NewSketch(int32_t k, const AllocatorType &allocator)
+        {
+            
             D_ASSERT(k >= 4);
             D_ASSERT(k <= 1024);
-            sketch = new datasketches::req_sketch<T>(k);
+            return SketchType(k, true, std::less<T>(), allocator);
+            
+        }
+
+        void CreateSketch(int32_t k, ArenaAllocator &arena)
+        {
+            D_ASSERT(!sketch);
+            sketch.Construct(NewSketch(k, GetAllocator(arena)));
+            FlushSmallBuffer();
+        }
+
+        // A sketch of the buffered values alone, used to finalize a group that never
+        // built its own. It is short lived and uses the heap, a sketch in the arena
+        // would stay there until the whole aggregate is destroyed.
+        SketchType SmallBufferSketch(int32_t k) const
+        {
+            auto result = NewSketch(k, AllocatorType());
+            ReplaySmallBuffer(result);
+            return result;
         }
-        
 
-        void CreateSketch(const DSREQState &existing)
+        
+        // Copy the sketch of a state that is kept after the combine. Other threads may
+        // combine the same state at the same time, so it is only read: the copy is an
+        // empty sketch of this state that the existing one is merged into.
+        void CreateSketch(const DSREQState &existing, ArenaAllocator &arena)
         {
+            D_ASSERT(!sketch);
             if (existing.sketch)
             {
-                
-                sketch = new datasketches::req_sketch<T>(*existing.sketch);
-                
+                sketch.Construct(NewSketch(existing.sketch->get_k(), GetAllocator(arena)));
+                sketch->merge(*existing.sketch);
+                FlushSmallBuffer();
             }
         }
 
         
-        datasketches::req_sketch<T> deserialize_sketch(const string_t &data)
+        // Take over the sketches of a state that is discarded after the combine. Their
+        // memory stays in the other arena, which lives as long as this one, and
+        // further buffers are taken from this state's arena.
+        void MoveFrom(DSREQState &existing, ArenaAllocator &arena)
         {
-            return datasketches::req_sketch<T>::deserialize(data.GetDataUnsafe(), data.GetSize());
+            D_ASSERT(!pool);
+            std::swap(pool, existing.pool);
+            if (pool)
+            {
+                pool->SetArena(arena);
+            }
+            D_ASSERT(!sketch);
+            if (existing.sketch)
+            {
+                sketch.Construct(std::move(*existing.sketch));
+                existing.sketch.Destroy();
+                FlushSmallBuffer();
+            }
+            
+            
         }
-        
-    };
 
+        
+        // Add an item, the sketch is only built once the buffer is full.
+        void Update(const T &item, int32_t k, ArenaAllocator &arena)
+        {
+            if (!sketch)
+            {
+                if (small_count < DS_SMALL_BUFFER_SIZE)
+                {
+                    small_items[small_count++] = item;
+                    return;
+                }
+                CreateSketch(k, arena);
+            }
+            sketch->update(item);
+        }
 
+        void ReplaySmallBuffer(SketchType &target) const
+        {
+            for (idx_t i = 0; i < small_count; i++)
+            {
+                target.update(small_items[i]);
+            }
+        }
 
-    
+        // Merge a sketch into the state's sketch as if it was merged count times. It
+        // is merged once, as a sketch built from the powers of two in count, each one
+        // the previous merged with itself.
+        void MergeRepeated(SketchType power, uint64_t count, int32_t k)
+        {
+            D_ASSERT(sketch);
+            auto repeated = NewSketch(k, AllocatorType());
+            while (true)
+            {
+                if (count & 1)
+                {
+                    repeated.merge(power);
+                }
+                count >>= 1;
+                if (count == 0)
+                {
+                    break;
+                }
+                power.merge(SketchType(power));
+            }
+            sketch->merge(repeated);
+        }
+        
+        
+
+        void FlushSmallBuffer()
+        {
+            D_ASSERT(sketch);
+            ReplaySmallBuffer(*sketch);
+            small_count = 0;
+        }
+
+        
+        
+
+        
+        // Deserialized sketches are short lived and use the heap.
+        static SketchType deserialize_sketch(const string_t &data)
+        {
+            
+            return SketchType::deserialize(data.GetDataUnsafe(), data.GetSize(), datasketches::serde<T>(), std::less<T>(),
+                                           AllocatorType());
+            
+        }
+
+        // Merge a serialized sketch into the state's sketch.
+        void MergeSerialized(const string_t &data)
+        {
+            
+            sketch->merge(deserialize_sketch(data));
+        }
+        
+    };
+
+
+
+    
     static LogicalType CreateREQSketchType(ExtensionLoader &loader, LogicalType embedded_type)
     {
         auto new_type = LogicalType(LogicalTypeId::BLOB);
@@ -361,20 +889,29 @@ struct DSTDigestBindData : public FunctionData {
 	}
 	explicit DSTDigestBindData(int32_t k) : k(k) {
 	}
+    
 
 	unique_ptr<FunctionData> Copy() const override {
+    
 		return make_uniq<DSTDigestBindData>(k);
+    
 	}
 
 	bool Equals(const FunctionData &other_p) const override {
 		auto &other = other_p.Cast<DSTDigestBindData>();
+    
         return k == other.k;
+    
 	}
 
     int32_t k;
+    
 };
 
+    
+
 
+    
 unique_ptr<FunctionData> DSTDigestBind(ClientContext &context, AggregateFunction &function,
                                             vector<unique_ptr<Expression>> &arguments) {
 	if (arguments[0]->HasParameter()) {
@@ -390,8 +927,10 @@ unique_ptr<FunctionData> DSTDigestBind(ClientContext &context, AggregateFunction
 
 	auto actual_k = k_val.GetValue<int32_t>();
 
+    
 	Function::EraseArgument(function, arguments, 0);
 	return make_uniq<DSTDigestBindData>(actual_k);
+    
 }
 
 
@@ -400,40 +939,209 @@ unique_ptr<FunctionData> DSTDigestBind(ClientContext &context, AggregateFunction
     
     struct DSTDigestState
     {
+        using SketchType = datasketches::tdigest<T, DSArenaAllocator<T>>;
+        
+        using AllocatorType = DSArenaAllocator<T>;
+        
+
+        // The sketches are kept inside the state and constructed with the first value.
+        
+        // Their buffers live in the aggregate's arena and the pool is created with the
+        // first sketch.
+        
+        DSArenaPool *pool = nullptr;
+        DSInline<SketchType> sketch;
+        
         
-        datasketches::tdigest<T> *sketch = nullptr;
         
+        // The items added before the sketch is built, in the order they were added.
+        // Once the sketch exists the buffer is empty.
+        T small_items[DS_SMALL_BUFFER_SIZE];
+        
+        uint8_t small_count = 0;
 
         ~DSTDigestState()
         {
-            if (sketch)
+            // The arena releases the memory of its blocks in bulk, the destructors only
+            // give back buffers that came from the heap or the buffer allocator.
+            if (pool)
             {
-                delete sketch;
+                pool->Release();
             }
+            sketch.Destroy();
+            
         }
 
         
-        void CreateSketch(uint16_t k)
+        AllocatorType GetAllocator(ArenaAllocator &arena)
+        {
+            if (!pool)
+            {
+                pool = DSArenaPool::Create(arena);
+            }
+            return AllocatorType(pool);
+        }
+        
+
+        
+        static SketchType NewSketch(uint16_t k, const AllocatorType &allocator)
+        {
+            
+            return SketchType(k, allocator);
+            
+        }
+
+        void CreateSketch(uint16_t k, ArenaAllocator &arena)
         {
             D_ASSERT(!sketch);
-            sketch = new datasketches::tdigest<T>(k);
+            sketch.Construct(NewSketch(k, GetAllocator(arena)));
+            FlushSmallBuffer();
+        }
+
+        // A sketch of the buffered values alone, used to finalize a group that never
+        // built its own. It is short lived and uses the heap, a sketch in the arena
+        // would stay there until the whole aggregate is destroyed.
+        SketchType SmallBufferSketch(uint16_t k) const
+        {
+            auto result = NewSketch(k, AllocatorType());
+            ReplaySmallBuffer(result);
+            return result;
         }
+
         
+        // Copy the sketch of a state that is kept after the combine. Other threads may
+        // combine the same state at the same time, so it is only read: the copy is an
+        // empty sketch of this state that the existing one is merged into.
+        void CreateSketch(const DSTDigestState &existing, ArenaAllocator &arena)
+        {
+            D_ASSERT(!sketch);
+            if (existing.sketch)
+            {
+                sketch.Construct(NewSketch(existing.sketch->get_k(), GetAllocator(arena)));
+                sketch->merge(*existing.sketch);
+                FlushSmallBuffer();
+            }
+        }
 
-        void CreateSketch(const DSTDigestState &existing)
+        
+        // Take over the sketches of a state that is discarded after the combine. Their
+        // memory stays in the other arena, which lives as long as this one, and
+        // further buffers are taken from this state's arena.
+        void MoveFrom(DSTDigestState &existing, ArenaAllocator &arena)
         {
+            D_ASSERT(!pool);
+            std::swap(pool, existing.pool);
+            if (pool)
+            {
+                pool->SetArena(arena);
+            }
+            D_ASSERT(!sketch);
             if (existing.sketch)
             {
-                
-                sketch = new datasketches::tdigest<T>(*existing.sketch);
-                
+                sketch.Construct(std::move(*existing.sketch));
+                existing.sketch.Destroy();
+                FlushSmallBuffer();
+            }
+            
+            
+        }
+
+        
+        // Add an item, the sketch is only built once the buffer is full.
+        void Update(const T &item, int32_t k, ArenaAllocator &arena)
+        {
+            if (!sketch)
+            {
+                if (small_count < DS_SMALL_BUFFER_SIZE)
+                {
+                    small_items[small_count++] = item;
+                    return;
+                }
+                CreateSketch(k, arena);
+            }
+            sketch->update(item);
+        }
+
+        void ReplaySmallBuffer(SketchType &target) const
+        {
+            for (idx_t i = 0; i < small_count; i++)
+            {
+                target.update(small_items[i]);
+            }
+        }
+
+        // Merge a sketch into the state's sketch as if it was merged count times. It
+        // is merged once, as a sketch built from the powers of two in count, each one
+        // the previous merged with itself.
+        void MergeRepeated(SketchType power, uint64_t count, int32_t k)
+        {
+            D_ASSERT(sketch);
+            auto repeated = NewSketch(k, AllocatorType());
+            while (true)
+            {
+                if (count & 1)
+                {
+                    repeated.merge(power);
+                }
+                count >>= 1;
+                if (count == 0)
+                {
+                    break;
+                }
+                power.merge(SketchType(power));
             }
+            sketch->merge(repeated);
         }
+        
 
+        // Add an item as if it was added weight times. Larger weights are merged in
+        // as a sketch that holds the item once, repeated weight times. All of its
+        // items are the same, so the compactions lose nothing.
+        void UpdateWeighted(const T &item, uint64_t weight, int32_t k, ArenaAllocator &arena)
+        {
+            if (weight <= DS_MAX_REPEATED_WEIGHT)
+            {
+                for (uint64_t i = 0; i < weight; i++)
+                {
+                    Update(item, k, arena);
+                }
+                return;
+            }
+            if (!sketch)
+            {
+                CreateSketch(k, arena);
+            }
+            auto single = NewSketch(k, AllocatorType());
+            single.update(item);
+            MergeRepeated(std::move(single), weight, k);
+        }
+        
         
-        datasketches::tdigest<T> deserialize_sketch(const string_t &data)
+
+        void FlushSmallBuffer()
         {
-            return datasketches::tdigest<T>::deserialize(data.GetDataUnsafe(), data.GetSize());
+            D_ASSERT(sketch);
+            ReplaySmallBuffer(*sketch);
+            small_count = 0;
+        }
+
+        
+        
+
+        
+        // Deserialized sketches are short lived and use the heap.
+        static SketchType deserialize_sketch(const string_t &data)
+        {
+            
+            return SketchType::deserialize(data.GetDataUnsafe(), data.GetSize(), AllocatorType());
+            
+        }
+
+        // Merge a serialized sketch into the state's sketch.
+        void MergeSerialized(const string_t &data)
+        {
+            
+            sketch->merge(deserialize_sketch(data));
         }
         
     };
@@ -468,20 +1176,81 @@ struct DSHLLBindData : public FunctionData {
 	}
 	explicit DSHLLBindData(int32_t k) : k(k) {
 	}
+    
+	DSHLLBindData(int32_t k, datasketches::target_hll_type target_type, bool compact)
+	    : k(k), target_type(target_type), compact(compact) {
+	}
+    
 
 	unique_ptr<FunctionData> Copy() const override {
-		return make_uniq<DSHLLBindData>(k);
+    
+		return make_uniq<DSHLLBindData>(k, target_type, compact);
+    
 	}
 
 	bool Equals(const FunctionData &other_p) const override {
 		auto &other = other_p.Cast<DSHLLBindData>();
-        return k == other.k;
+    
+        return k == other.k && target_type == other.target_type && compact == other.compact;
+    
 	}
 
     int32_t k;
+    
+    // Type of the HLL array of the result sketches and whether they are serialized
+    // in the compact form.
+    datasketches::target_hll_type target_type = datasketches::target_hll_type::HLL_4;
+    bool compact = false;
+    
+};
+
+    
+struct DSHLLEnumBindData : public DSHLLBindData {
+	DSHLLEnumBindData(const DSHLLBindData &bind_data, vector<string> members)
+	    : DSHLLBindData(bind_data), members(std::move(members)) {
+	}
+
+	unique_ptr<FunctionData> Copy() const override {
+		return make_uniq<DSHLLEnumBindData>(*this, members);
+	}
+
+	bool Equals(const FunctionData &other_p) const override {
+		auto &other = other_p.Cast<DSHLLEnumBindData>();
+        return DSHLLBindData::Equals(other_p) && members == other.members;
+	}
+
+    // The member strings of the ENUM type indexed by ordinal.
+    vector<string> members;
 };
+    
 
 
+    
+static datasketches::target_hll_type DSHLLTargetType(ClientContext &context, Expression &argument) {
+	if (argument.HasParameter()) {
+		throw ParameterNotResolvedException();
+	}
+	if (!argument.IsFoldable()) {
+		throw BinderException("HLL can only take a constant target type");
+	}
+	Value type_val = ExpressionExecutor::EvaluateScalar(context, argument);
+	if (type_val.IsNull()) {
+		throw BinderException("HLL target type cannot be NULL");
+	}
+	auto name = StringUtil::Upper(type_val.ToString());
+	if (name == "HLL_4") {
+		return datasketches::target_hll_type::HLL_4;
+	}
+	if (name == "HLL_6") {
+		return datasketches::target_hll_type::HLL_6;
+	}
+	if (name == "HLL_8") {
+		return datasketches::target_hll_type::HLL_8;
+	}
+	throw BinderException("HLL target type must be HLL_4, HLL_6 or HLL_8, not '%s'", type_val.ToString());
+}
+
+    
 unique_ptr<FunctionData> DSHLLBind(ClientContext &context, AggregateFunction &function,
                                             vector<unique_ptr<Expression>> &arguments) {
 	if (arguments[0]->HasParameter()) {
@@ -497,48 +1266,272 @@ unique_ptr<FunctionData> DSHLLBind(ClientContext &context, AggregateFunction &fu
 
 	auto actual_k = k_val.GetValue<int32_t>();
 
+    
+	// The optional last argument is the type of the HLL array of the result.
+	auto target_type = datasketches::target_hll_type::HLL_4;
+	if (arguments.size() == 3) {
+		target_type = DSHLLTargetType(context, *arguments[2]);
+		Function::EraseArgument(function, arguments, 2);
+	}
+	Value compact_val;
+	bool compact = context.TryGetCurrentSetting("datasketches_hll_compact", compact_val) && !compact_val.IsNull() &&
+	               compact_val.GetValue<bool>();
+
 	Function::EraseArgument(function, arguments, 0);
-	return make_uniq<DSHLLBindData>(actual_k);
+	return make_uniq<DSHLLBindData>(actual_k, target_type, compact);
+    
 }
 
 
     
     struct DSHLLState
     {
+        using SketchType = datasketches::hll_sketch_alloc<DSBufferAllocator<uint8_t>>;
         
-        datasketches::hll_sketch *sketch = nullptr;
+        using UnionType = datasketches::hll_union_alloc<DSBufferAllocator<uint8_t>>;
+        using AllocatorType = DSBufferAllocator<uint8_t>;
         
 
+        // The sketches are kept inside the state and constructed with the first value.
+        
+        // Their buffers come from DuckDB's buffer allocator, the pool in the
+        // aggregate's arena is only used for the registers of the HLL union.
+        
+        DSArenaPool *pool = nullptr;
+        DSInline<SketchType> sketch;
+        
+        // Union that accumulates the merged sketches, the result is only materialized
+        // when the aggregate is finalized.
+        DSInline<UnionType> sketch_union;
+        
+        
+        // Register-wise maximum of the serialized sketches merged after the union
+        // reached HLL mode, folded into the union by FlushRegisters(). They are kept
+        // in the arena like the sketches.
+        std::vector<uint8_t, DSArenaAllocator<uint8_t>> registers;
+        uint8_t registers_lg_k = 0;
+        bool union_has_hll = false;
+        
+        
+        // The distinct numeric values seen before the sketch is built, as the 8 bytes
+        // the sketch hashes for them. Once the sketch exists the buffer is empty.
+        uint64_t small_keys[DS_SMALL_BUFFER_SIZE];
+        
+        uint8_t small_count = 0;
+
         ~DSHLLState()
         {
-            if (sketch)
+            // The arena releases the memory of its blocks in bulk, the destructors only
+            // give back buffers that came from the heap or the buffer allocator.
+            if (pool)
             {
-                delete sketch;
+                pool->Release();
             }
+            sketch.Destroy();
+            
+            sketch_union.Destroy();
+            
         }
 
         
-        void CreateSketch(uint16_t k)
+        AllocatorType GetAllocator(ArenaAllocator &arena)
         {
-            D_ASSERT(!sketch);
-            sketch = new datasketches::hll_sketch(k);
+            return AllocatorType(&arena.GetAllocator());
+        }
+        
+
+        DSArenaAllocator<uint8_t> GetPoolAllocator(ArenaAllocator &arena)
+        {
+            if (!pool)
+            {
+                pool = DSArenaPool::Create(arena);
+            }
+            return DSArenaAllocator<uint8_t>(pool);
         }
         
+        
+
+        
+        static SketchType NewSketch(uint16_t k, const AllocatorType &allocator)
+        {
+            
+            return SketchType(k, datasketches::target_hll_type::HLL_4, false, allocator);
+            
+        }
+
+        void CreateSketch(uint16_t k, ArenaAllocator &arena)
+        {
+            D_ASSERT(!sketch);
+            sketch.Construct(NewSketch(k, GetAllocator(arena)));
+            FlushSmallBuffer();
+        }
+
+        // A sketch of the buffered values alone, used to finalize a group that never
+        // built its own. It is short lived and uses the heap, a sketch in the arena
+        // would stay there until the whole aggregate is destroyed.
+        SketchType SmallBufferSketch(uint16_t k) const
+        {
+            auto result = NewSketch(k, AllocatorType());
+            ReplaySmallBuffer(result);
+            return result;
+        }
 
-        void CreateSketch(const DSHLLState &existing)
+        
+        // Take over the sketches of a state that is discarded after the combine. Their
+        // memory stays in the other arena, which lives as long as this one, and
+        // further buffers are taken from this state's arena.
+        void MoveFrom(DSHLLState &existing, ArenaAllocator &arena)
         {
+            D_ASSERT(!pool);
+            std::swap(pool, existing.pool);
+            if (pool)
+            {
+                pool->SetArena(arena);
+            }
+            D_ASSERT(!sketch);
             if (existing.sketch)
             {
-                
-                sketch = new datasketches::hll_sketch(*existing.sketch);
-                
+                sketch.Construct(std::move(*existing.sketch));
+                existing.sketch.Destroy();
+                FlushSmallBuffer();
+            }
+            
+            D_ASSERT(!sketch_union);
+            if (existing.sketch_union)
+            {
+                sketch_union.Construct(std::move(*existing.sketch_union));
+                existing.sketch_union.Destroy();
+            }
+            
+            
+            registers = std::move(existing.registers);
+            registers_lg_k = existing.registers_lg_k;
+            union_has_hll = existing.union_has_hll;
+            
+        }
+
+        
+        // Add the key of a numeric value, the sketch is only built once the buffer
+        // cannot take another distinct key.
+        void UpdateKey(uint64_t key, int32_t k, ArenaAllocator &arena)
+        {
+            if (!sketch)
+            {
+                for (idx_t i = 0; i < small_count; i++)
+                {
+                    if (small_keys[i] == key)
+                    {
+                        return;
+                    }
+                }
+                if (small_count < DS_SMALL_BUFFER_SIZE)
+                {
+                    small_keys[small_count++] = key;
+                    return;
+                }
+                CreateSketch(k, arena);
+            }
+            sketch->update(&key, sizeof(key));
+        }
+
+        void ReplaySmallBuffer(SketchType &target) const
+        {
+            for (idx_t i = 0; i < small_count; i++)
+            {
+                target.update(&small_keys[i], sizeof(uint64_t));
+            }
+        }
+        
+
+        void FlushSmallBuffer()
+        {
+            D_ASSERT(sketch);
+            ReplaySmallBuffer(*sketch);
+            small_count = 0;
+        }
+
+        
+        void CreateUnion(uint8_t lg_k, ArenaAllocator &arena)
+        {
+            D_ASSERT(!sketch_union);
+            sketch_union.Construct(lg_k, GetAllocator(arena));
+        }
+        
+        
+
+        // Merge a serialized sketch into the union. Once the union holds a sketch in
+        // HLL mode, the union of every further HLL mode sketch with lg_k registers is
+        // just the register-wise maximum, so those are merged straight from their
+        // bytes into the registers instead of being deserialized.
+        void UnionSerialized(const string_t &data, int32_t lg_k, ArenaAllocator &arena)
+        {
+            D_ASSERT(sketch_union);
+            auto bytes = data.GetDataUnsafe();
+            auto size = data.GetSize();
+            if (union_has_hll && lg_k >= DSHLLLayout::MIN_LG_K && lg_k <= DSHLLLayout::MAX_LG_K)
+            {
+                if (!registers.empty())
+                {
+                    if (DSHLLMaxSerialized(registers.data(), registers_lg_k, bytes, size))
+                    {
+                        return;
+                    }
+                }
+                else if (DSHLLIsHLLMode(bytes, size) &&
+                         reinterpret_cast<const uint8_t *>(bytes)[DSHLLLayout::LG_K_BYTE] == lg_k &&
+                         DSHLLHasRegisters(reinterpret_cast<const uint8_t *>(bytes), size))
+                {
+                    // The registers are only allocated for a sketch that can be merged
+                    // into them, LIST and SET mode sketches and sketches of another
+                    // lg_k go through the union.
+                    std::vector<uint8_t, DSArenaAllocator<uint8_t>> initial(idx_t(1) << lg_k, 0, GetPoolAllocator(arena));
+                    if (DSHLLMaxSerialized(initial.data(), static_cast<uint8_t>(lg_k), bytes, size))
+                    {
+                        registers = std::move(initial);
+                        registers_lg_k = static_cast<uint8_t>(lg_k);
+                        return;
+                    }
+                }
             }
+            union_has_hll = union_has_hll || DSHLLIsHLLMode(bytes, size);
+            sketch_union->update(deserialize_sketch(data));
         }
 
+        void CombineRegisters(const DSHLLState &source, ArenaAllocator &arena)
+        {
+            union_has_hll = union_has_hll || source.union_has_hll;
+            if (source.registers.empty())
+            {
+                return;
+            }
+            if (registers.empty())
+            {
+                registers = std::vector<uint8_t, DSArenaAllocator<uint8_t>>(source.registers.begin(),
+                                                                            source.registers.end(),
+                                                                            GetPoolAllocator(arena));
+                registers_lg_k = source.registers_lg_k;
+                return;
+            }
+            D_ASSERT(registers_lg_k == source.registers_lg_k);
+            DSHLLMaxRegisters(registers.data(), source.registers.data(), registers.size());
+        }
+
+        void FlushRegisters()
+        {
+            if (registers.empty())
+            {
+                return;
+            }
+            auto serialized = DSHLL8Serialize(registers.data(), registers_lg_k);
+            sketch_union->update(SketchType::deserialize(serialized.data(), serialized.size()));
+            registers.clear();
+        }
+        
+
         
-        datasketches::hll_sketch deserialize_sketch(const string_t &data)
+        static SketchType deserialize_sketch(const string_t &data)
         {
-            return datasketches::hll_sketch::deserialize(data.GetDataUnsafe(), data.GetSize());
+            return SketchType::deserialize(data.GetDataUnsafe(), data.GetSize());
         }
         
     };
@@ -570,20 +1563,47 @@ struct DSCPCBindData : public FunctionData {
 	}
 	explicit DSCPCBindData(int32_t k) : k(k) {
 	}
+    
 
 	unique_ptr<FunctionData> Copy() const override {
+    
 		return make_uniq<DSCPCBindData>(k);
+    
 	}
 
 	bool Equals(const FunctionData &other_p) const override {
 		auto &other = other_p.Cast<DSCPCBindData>();
+    
         return k == other.k;
+    
 	}
 
     int32_t k;
+    
 };
 
+    
+struct DSCPCEnumBindData : public DSCPCBindData {
+	DSCPCEnumBindData(const DSCPCBindData &bind_data, vector<string> members)
+	    : DSCPCBindData(bind_data), members(std::move(members)) {
+	}
 
+	unique_ptr<FunctionData> Copy() const override {
+		return make_uniq<DSCPCEnumBindData>(*this, members);
+	}
+
+	bool Equals(const FunctionData &other_p) const override {
+		auto &other = other_p.Cast<DSCPCEnumBindData>();
+        return DSCPCBindData::Equals(other_p) && members == other.members;
+	}
+
+    // The member strings of the ENUM type indexed by ordinal.
+    vector<string> members;
+};
+    
+
+
+    
 unique_ptr<FunctionData> DSCPCBind(ClientContext &context, AggregateFunction &function,
                                             vector<unique_ptr<Expression>> &arguments) {
 	if (arguments[0]->HasParameter()) {
@@ -599,48 +1619,172 @@ unique_ptr<FunctionData> DSCPCBind(ClientContext &context, AggregateFunction &fu
 
 	auto actual_k = k_val.GetValue<int32_t>();
 
+    
 	Function::EraseArgument(function, arguments, 0);
 	return make_uniq<DSCPCBindData>(actual_k);
+    
 }
 
 
     
     struct DSCPCState
     {
+        using SketchType = datasketches::cpc_sketch_alloc<DSBufferAllocator<uint8_t>>;
         
-        datasketches::cpc_sketch *sketch = nullptr;
+        using UnionType = datasketches::cpc_union_alloc<DSBufferAllocator<uint8_t>>;
+        using AllocatorType = DSBufferAllocator<uint8_t>;
         
 
+        // The sketches are kept inside the state and constructed with the first value.
+        
+        // Their buffers come from DuckDB's buffer allocator, the pool in the
+        // aggregate's arena is only used for the registers of the HLL union.
+        
+        DSArenaPool *pool = nullptr;
+        DSInline<SketchType> sketch;
+        
+        // Union that accumulates the merged sketches, the result is only materialized
+        // when the aggregate is finalized.
+        DSInline<UnionType> sketch_union;
+        
+        
+        
+        // The distinct numeric values seen before the sketch is built, as the 8 bytes
+        // the sketch hashes for them. Once the sketch exists the buffer is empty.
+        uint64_t small_keys[DS_SMALL_BUFFER_SIZE];
+        
+        uint8_t small_count = 0;
+
         ~DSCPCState()
         {
-            if (sketch)
+            // The arena releases the memory of its blocks in bulk, the destructors only
+            // give back buffers that came from the heap or the buffer allocator.
+            if (pool)
             {
-                delete sketch;
+                pool->Release();
             }
+            sketch.Destroy();
+            
+            sketch_union.Destroy();
+            
         }
 
         
-        void CreateSketch(uint8_t k)
+        AllocatorType GetAllocator(ArenaAllocator &arena)
         {
-            D_ASSERT(!sketch);
-            sketch = new datasketches::cpc_sketch(k);
+            return AllocatorType(&arena.GetAllocator());
         }
         
+        
 
-        void CreateSketch(const DSCPCState &existing)
+        
+        static SketchType NewSketch(uint8_t k, const AllocatorType &allocator)
         {
+            
+            return SketchType(k, datasketches::DEFAULT_SEED, allocator);
+            
+        }
+
+        void CreateSketch(uint8_t k, ArenaAllocator &arena)
+        {
+            D_ASSERT(!sketch);
+            sketch.Construct(NewSketch(k, GetAllocator(arena)));
+            FlushSmallBuffer();
+        }
+
+        // A sketch of the buffered values alone, used to finalize a group that never
+        // built its own. It is short lived and uses the heap, a sketch in the arena
+        // would stay there until the whole aggregate is destroyed.
+        SketchType SmallBufferSketch(uint8_t k) const
+        {
+            auto result = NewSketch(k, AllocatorType());
+            ReplaySmallBuffer(result);
+            return result;
+        }
+
+        
+        // Take over the sketches of a state that is discarded after the combine. Their
+        // memory stays in the other arena, which lives as long as this one, and
+        // further buffers are taken from this state's arena.
+        void MoveFrom(DSCPCState &existing, ArenaAllocator &arena)
+        {
+            D_ASSERT(!pool);
+            std::swap(pool, existing.pool);
+            if (pool)
+            {
+                pool->SetArena(arena);
+            }
+            D_ASSERT(!sketch);
             if (existing.sketch)
             {
-                
-                sketch = new datasketches::cpc_sketch(*existing.sketch);
-                
+                sketch.Construct(std::move(*existing.sketch));
+                existing.sketch.Destroy();
+                FlushSmallBuffer();
             }
+            
+            D_ASSERT(!sketch_union);
+            if (existing.sketch_union)
+            {
+                sketch_union.Construct(std::move(*existing.sketch_union));
+                existing.sketch_union.Destroy();
+            }
+            
+            
+        }
+
+        
+        // Add the key of a numeric value, the sketch is only built once the buffer
+        // cannot take another distinct key.
+        void UpdateKey(uint64_t key, int32_t k, ArenaAllocator &arena)
+        {
+            if (!sketch)
+            {
+                for (idx_t i = 0; i < small_count; i++)
+                {
+                    if (small_keys[i] == key)
+                    {
+                        return;
+                    }
+                }
+                if (small_count < DS_SMALL_BUFFER_SIZE)
+                {
+                    small_keys[small_count++] = key;
+                    return;
+                }
+                CreateSketch(k, arena);
+            }
+            sketch->update(&key, sizeof(key));
+        }
+
+        void ReplaySmallBuffer(SketchType &target) const
+        {
+            for (idx_t i = 0; i < small_count; i++)
+            {
+                target.update(&small_keys[i], sizeof(uint64_t));
+            }
+        }
+        
+
+        void FlushSmallBuffer()
+        {
+            D_ASSERT(sketch);
+            ReplaySmallBuffer(*sketch);
+            small_count = 0;
+        }
+
+        
+        void CreateUnion(uint8_t lg_k, ArenaAllocator &arena)
+        {
+            D_ASSERT(!sketch_union);
+            sketch_union.Construct(lg_k, datasketches::DEFAULT_SEED, GetAllocator(arena));
         }
+        
+        
 
         
-        datasketches::cpc_sketch deserialize_sketch(const string_t &data)
+        static SketchType deserialize_sketch(const string_t &data)
         {
-            return datasketches::cpc_sketch::deserialize(data.GetDataUnsafe(), data.GetSize());
+            return SketchType::deserialize(data.GetDataUnsafe(), data.GetSize());
         }
         
     };
@@ -670,19 +1814,145 @@ unique_ptr<FunctionData> DSCPCBind(ClientContext &context, AggregateFunction &fu
         template <class STATE>
         static void Initialize(STATE &state)
         {
-            state.sketch = nullptr;
+            new (&state) STATE();
+        }
+
+        template <class STATE>
+        static void Destroy(STATE &state, AggregateInputData &aggr_input_data) {
+            state.~STATE();
+        }
+
+        static bool IgnoreNull() { return true; }
+
+        // Whether the source state of a Combine is discarded afterwards, its sketches
+        // can then be taken over instead of copied.
+        static bool CanTakeSource(const AggregateInputData &aggr_input_data)
+        {
+            return aggr_input_data.combine_type == AggregateCombineType::ALLOW_DESTRUCTIVE;
+        }
+    };
+
+    // Stream buffer over the blob of a result row. The library's stream serialization
+    // then writes the sketch straight into the string heap of the result vector.
+    class DSBlobStreamBuffer : public std::streambuf
+    {
+    public:
+        DSBlobStreamBuffer(char *data, size_t size)
+        {
+            setp(data, data + size);
+        }
+
+        size_t Written() const
+        {
+            return static_cast<size_t>(pptr() - pbase());
+        }
+    };
+
+    // Serialize into a new blob of the result vector, size is the exact number of
+    // bytes that serialize() writes to the stream.
+    template <class SERIALIZE>
+    static string_t DSSerializeIntoResult(Vector &result, size_t size, SERIALIZE &&serialize)
+    {
+        auto blob = StringVector::EmptyString(result, size);
+        DSBlobStreamBuffer buffer(blob.GetDataWriteable(), size);
+        std::ostream stream(&buffer);
+        serialize(stream);
+        if (buffer.Written() != size)
+        {
+            throw InternalException("Serialized sketch has %d bytes instead of %d", buffer.Written(), size);
+        }
+        blob.Finalize();
+        return blob;
+    }
+
+    template <class SKETCH>
+    static string_t DSSerializeSketch(Vector &result, const SKETCH &sketch)
+    {
+        return DSSerializeIntoResult(result, sketch.get_serialized_size_bytes(),
+                                     [&](std::ostream &stream) { sketch.serialize(stream); });
+    }
+
+    template <class A>
+    static string_t DSSerializeSketch(Vector &result, const datasketches::hll_sketch_alloc<A> &sketch, bool compact = false)
+    {
+        if (compact)
+        {
+            return DSSerializeIntoResult(result, sketch.get_compact_serialization_bytes(),
+                                         [&](std::ostream &stream) { sketch.serialize_compact(stream); });
+        }
+        return DSSerializeIntoResult(result, sketch.get_updatable_serialization_bytes(),
+                                     [&](std::ostream &stream) { sketch.serialize_updatable(stream); });
+    }
+
+    // Serialize an HLL sketch with the target type and the form chosen in the bind data.
+    template <class A, class BIND_DATA_TYPE>
+    static string_t DSSerializeHLL(Vector &result, const datasketches::hll_sketch_alloc<A> &sketch,
+                                   const BIND_DATA_TYPE &bind_data)
+    {
+        if (sketch.get_target_type() == bind_data.target_type)
+        {
+            return DSSerializeSketch(result, sketch, bind_data.compact);
+        }
+        return DSSerializeSketch(result, datasketches::hll_sketch_alloc<A>(sketch, bind_data.target_type), bind_data.compact);
+    }
+
+    // The size of a CPC sketch is only known once it is compressed, it is serialized
+    // to bytes and copied.
+    template <class A>
+    static string_t DSSerializeSketch(Vector &result, const datasketches::cpc_sketch_alloc<A> &sketch)
+    {
+        auto serialized_data = sketch.serialize();
+        return StringVector::AddStringOrBlob(result, const_char_ptr_cast(serialized_data.data()), serialized_data.size());
+    }
+
+    // Feed a single value into a distinct counting sketch, strings and blobs are
+    // hashed by their bytes.
+    template <class SKETCH, class T>
+    static inline void DSCountingSketchUpdate(SKETCH &sketch, const T &value)
+    {
+        if constexpr (std::is_same_v<T, duckdb::string_t>) {
+            sketch.update(value.GetData(), value.GetSize());
+        } else {
+            sketch.update(value);
+        }
+    }
+
+    // The 8 bytes a distinct counting sketch hashes for a numeric value. Integers are
+    // widened to 64 bits, unsigned ones through the signed type of the same width,
+    // and floating point values are hashed as canonical doubles, like the library's
+    // typed update() does.
+    template <class T>
+    static inline uint64_t DSCountingSketchKey(const T &value)
+    {
+        if constexpr (std::is_floating_point_v<T>) {
+            double canonical = value == 0 ? 0.0 : static_cast<double>(value);
+            if (std::isnan(canonical)) {
+                return 0x7ff8000000000000ULL;
+            }
+            uint64_t key;
+            memcpy(&key, &canonical, sizeof(key));
+            return key;
+        } else if constexpr (std::is_same_v<T, uint64_t>) {
+            return value;
+        } else {
+            return static_cast<uint64_t>(static_cast<int64_t>(static_cast<std::make_signed_t<T>>(value)));
         }
+    }
 
-        template <class STATE>
-        static void Destroy(STATE &state, AggregateInputData &aggr_input_data) {
-            if (state.sketch) {
-                delete state.sketch;
-                state.sketch = nullptr;
+    // Feed a single value into the state of a distinct counting sketch. Numeric values
+    // go through the state's small buffer, strings and blobs build the sketch.
+    template <class STATE, class T>
+    static inline void DSCountingSketchStateUpdate(STATE &state, int32_t k, ArenaAllocator &arena, const T &value)
+    {
+        if constexpr (std::is_same_v<T, duckdb::string_t>) {
+            if (!state.sketch) {
+                state.CreateSketch(k, arena);
             }
+            DSCountingSketchUpdate(*state.sketch, value);
+        } else {
+            state.UpdateKey(DSCountingSketchKey(value), k, arena);
         }
-
-        static bool IgnoreNull() { return true; }
-    };
+    }
 
     template <class BIND_DATA_TYPE>
     struct DSQuantilesMergeOperation : DSSketchOperationBase
@@ -695,31 +1965,54 @@ unique_ptr<FunctionData> DSCPCBind(ClientContext &context, AggregateFunction &fu
             if (!state.sketch)
             {
                 auto &bind_data = idata.input.bind_data->template Cast<BIND_DATA_TYPE>();
-                state.CreateSketch(bind_data.k);
+                state.CreateSketch(bind_data.k, idata.input.allocator);
             }
 
-            // this is a sketch in b_data, so we need to deserialize it.
-            state.sketch->merge(state.deserialize_sketch(a_data));
+            state.MergeSerialized(a_data);
         }
 
         template <class INPUT_TYPE, class STATE, class OP>
         static void ConstantOperation(STATE &state, const INPUT_TYPE &input, AggregateUnaryInput &unary_input,
                                     idx_t count) {
-            for (idx_t i = 0; i < count; i++) {
+            if (count == 1)
+            {
                 Operation<INPUT_TYPE, STATE, OP>(state, input, unary_input);
+                return;
+            }
+            auto &bind_data = unary_input.input.bind_data->template Cast<BIND_DATA_TYPE>();
+            if (!state.sketch)
+            {
+                state.CreateSketch(bind_data.k, unary_input.input.allocator);
             }
+
+            // The same sketch is deserialized once and merged with a multiplicity.
+            state.MergeRepeated(state.deserialize_sketch(input), count, bind_data.k);
         }
 
         template <class STATE, class OP>
         static void Combine(const STATE &source, STATE &target,
                             AggregateInputData &aggr_input_data)
         {
+            if (!source.sketch)
+            {
+                return;
+            }
             if (!target.sketch)
             {
-                target.CreateSketch(source);
+                if (CanTakeSource(aggr_input_data))
+                {
+                    target.MoveFrom(const_cast<STATE &>(source), aggr_input_data.allocator);
+                }
+                else
+                {
+                    target.CreateSketch(source, aggr_input_data.allocator);
+                }
             }
             else
             {
+                // Merged as a const source, which other threads may read at the same
+                // time. Only the classic quantiles sketch may keep memory of the
+                // source's allocator, it uses the thread-safe buffer allocator.
                 target.sketch->merge(*source.sketch);
             }
         }
@@ -734,9 +2027,7 @@ unique_ptr<FunctionData> DSCPCBind(ClientContext &context, AggregateFunction &fu
             }
             else
             {
-                auto serialized_data = state.sketch->serialize();
-                auto sketch_string = std::string(serialized_data.begin(), serialized_data.end());
-                target = StringVector::AddStringOrBlob(finalize_data.result, sketch_string);
+                target = DSSerializeSketch(finalize_data.result, *state.sketch);
             }
         }
     };
@@ -749,13 +2040,8 @@ unique_ptr<FunctionData> DSCPCBind(ClientContext &context, AggregateFunction &fu
                               const A_TYPE &a_data,
                               AggregateUnaryInput &idata)
         {
-            if (!state.sketch)
-            {
-                auto &bind_data = idata.input.bind_data->template Cast<BIND_DATA_TYPE>();
-                state.CreateSketch(bind_data.k);
-            }
-
-            state.sketch->update(a_data);
+            auto &bind_data = idata.input.bind_data->template Cast<BIND_DATA_TYPE>();
+            state.Update(a_data, bind_data.k, idata.input.allocator);
         }
 
         template <class INPUT_TYPE, class STATE, class OP>
@@ -770,12 +2056,32 @@ unique_ptr<FunctionData> DSCPCBind(ClientContext &context, AggregateFunction &fu
         static void Combine(const STATE &source, STATE &target,
                             AggregateInputData &aggr_input_data)
         {
+            if (!source.sketch)
+            {
+                // The source only has buffered items, they are added like new ones.
+                auto &bind_data = aggr_input_data.bind_data->template Cast<BIND_DATA_TYPE>();
+                for (idx_t i = 0; i < source.small_count; i++)
+                {
+                    target.Update(source.small_items[i], bind_data.k, aggr_input_data.allocator);
+                }
+                return;
+            }
             if (!target.sketch)
             {
-                target.CreateSketch(source);
+                if (CanTakeSource(aggr_input_data))
+                {
+                    target.MoveFrom(const_cast<STATE &>(source), aggr_input_data.allocator);
+                }
+                else
+                {
+                    target.CreateSketch(source, aggr_input_data.allocator);
+                }
             }
             else
             {
+                // Merged as a const source, which other threads may read at the same
+                // time. Only the classic quantiles sketch may keep memory of the
+                // source's allocator, it uses the thread-safe buffer allocator.
                 target.sketch->merge(*source.sketch);
             }
         }
@@ -784,16 +2090,37 @@ unique_ptr<FunctionData> DSCPCBind(ClientContext &context, AggregateFunction &fu
         static void Finalize(STATE &state, T &target,
                              AggregateFinalizeData &finalize_data)
         {
-            if (!state.sketch)
+            if (state.sketch)
             {
-                finalize_data.ReturnNull();
+                target = DSSerializeSketch(finalize_data.result, *state.sketch);
+            }
+            else if (state.small_count > 0)
+            {
+                // A group that never filled the buffer still gets a standard sketch.
+                auto &bind_data = finalize_data.input.bind_data->template Cast<BIND_DATA_TYPE>();
+                target = DSSerializeSketch(finalize_data.result, state.SmallBufferSketch(bind_data.k));
             }
             else
             {
-                auto serialized_data = state.sketch->serialize();
-                auto sketch_string = std::string(serialized_data.begin(), serialized_data.end());
-                target = StringVector::AddStringOrBlob(finalize_data.result, sketch_string);
+                finalize_data.ReturnNull();
+            }
+        }
+    };
+
+    // Create operation for (value, weight) rows, a row is added as weight copies of
+    // the value.
+    template <class BIND_DATA_TYPE>
+    struct DSQuantilesWeightedCreateOperation : DSQuantilesCreateOperation<BIND_DATA_TYPE>
+    {
+        template <class A_TYPE, class B_TYPE, class STATE, class OP>
+        static void Operation(STATE &state, const A_TYPE &a_data, const B_TYPE &weight, AggregateBinaryInput &idata)
+        {
+            if (weight < 0)
+            {
+                throw InvalidInputException("Weight cannot be negative: %d", weight);
             }
+            auto &bind_data = idata.input.bind_data->template Cast<BIND_DATA_TYPE>();
+            state.UpdateWeighted(a_data, static_cast<uint64_t>(weight), bind_data.k, idata.input.allocator);
         }
     };
 
@@ -805,23 +2132,15 @@ unique_ptr<FunctionData> DSCPCBind(ClientContext &context, AggregateFunction &fu
                               const A_TYPE &a_data,
                               AggregateUnaryInput &idata)
         {
-            if (!state.sketch)
-            {
-                auto &bind_data = idata.input.bind_data->template Cast<BIND_DATA_TYPE>();
-                state.CreateSketch(bind_data.k);
-            }
-
-            if constexpr (std::is_same_v<A_TYPE, duckdb::string_t>) {
-                state.sketch->update(a_data.GetData(), a_data.GetSize());
-            } else {
-                state.sketch->update(a_data);
-            }
+            auto &bind_data = idata.input.bind_data->template Cast<BIND_DATA_TYPE>();
+            DSCountingSketchStateUpdate(state, bind_data.k, idata.input.allocator, a_data);
         }
 
         template <class INPUT_TYPE, class STATE, class OP>
         static void ConstantOperation(STATE &state, const INPUT_TYPE &input, AggregateUnaryInput &unary_input,
                                     idx_t count) {
-            for (idx_t i = 0; i < count; i++) {
+            // The sketch ignores duplicates, so a single update is the same as count updates.
+            if (count > 0) {
                 Operation<INPUT_TYPE, STATE, OP>(state, input, unary_input);
             }
         }
@@ -830,18 +2149,35 @@ unique_ptr<FunctionData> DSCPCBind(ClientContext &context, AggregateFunction &fu
         static void Combine(const STATE &source, STATE &target,
                             AggregateInputData &aggr_input_data)
         {
-            if (!target.sketch)
+            // Buffered keys of the source are added like new values.
+            auto &bind_data = aggr_input_data.bind_data->template Cast<BIND_DATA_TYPE>();
+            for (idx_t i = 0; i < source.small_count; i++)
             {
-                target.CreateSketch(source);
+                target.UpdateKey(source.small_keys[i], bind_data.k, aggr_input_data.allocator);
             }
-            else
+            if (!source.sketch && !source.sketch_union)
             {
-                datasketches::hll_union u(target.sketch->get_lg_config_k());
-                u.update(*target.sketch);
-                if(source.sketch) {
-                    u.update(*source.sketch);
-                }
-                *target.sketch = u.get_result(datasketches::target_hll_type::HLL_4);
+                return;
+            }
+            if (!target.sketch && !target.sketch_union && CanTakeSource(aggr_input_data))
+            {
+                target.MoveFrom(const_cast<STATE &>(source), aggr_input_data.allocator);
+                return;
+            }
+
+            // The thread partials are accumulated in the union's native HLL_8 layout,
+            // the conversion to the target type only happens once in Finalize.
+            if (!target.sketch_union)
+            {
+                target.CreateUnion(bind_data.k, aggr_input_data.allocator);
+            }
+            if (source.sketch)
+            {
+                target.sketch_union->update(*source.sketch);
+            }
+            if (source.sketch_union)
+            {
+                target.sketch_union->update(source.sketch_union->get_result(datasketches::target_hll_type::HLL_8));
             }
         }
 
@@ -849,15 +2185,32 @@ unique_ptr<FunctionData> DSCPCBind(ClientContext &context, AggregateFunction &fu
         static void Finalize(STATE &state, T &target,
                              AggregateFinalizeData &finalize_data)
         {
-            if (!state.sketch)
+            auto &bind_data = finalize_data.input.bind_data->template Cast<BIND_DATA_TYPE>();
+            if (state.sketch_union)
             {
-                finalize_data.ReturnNull();
+                if (state.sketch)
+                {
+                    state.sketch_union->update(*state.sketch);
+                }
+                else if (state.small_count > 0)
+                {
+                    state.sketch_union->update(state.SmallBufferSketch(bind_data.k));
+                }
+                target = DSSerializeHLL(finalize_data.result, state.sketch_union->get_result(bind_data.target_type),
+                                        bind_data);
+            }
+            else if (state.sketch)
+            {
+                target = DSSerializeHLL(finalize_data.result, *state.sketch, bind_data);
+            }
+            else if (state.small_count > 0)
+            {
+                // A group that never filled the buffer still gets a standard sketch.
+                target = DSSerializeHLL(finalize_data.result, state.SmallBufferSketch(bind_data.k), bind_data);
             }
             else
             {
-                auto serialized_data = state.sketch->serialize_updatable();
-                auto sketch_string = std::string(serialized_data.begin(), serialized_data.end());
-                target = StringVector::AddStringOrBlob(finalize_data.result, sketch_string);
+                finalize_data.ReturnNull();
             }
         }
     };
@@ -872,27 +2225,19 @@ unique_ptr<FunctionData> DSCPCBind(ClientContext &context, AggregateFunction &fu
                               AggregateUnaryInput &idata)
         {
             auto &bind_data = idata.input.bind_data->template Cast<BIND_DATA_TYPE>();
-
-            if (!state.sketch)
+            if (!state.sketch_union)
             {
-                state.CreateSketch(bind_data.k);
-            }
-
-            auto a_sketch = state.deserialize_sketch(a_data);
-
-            datasketches::hll_union u(bind_data.k);
-            if(state.sketch) {
-                u.update(*state.sketch);
+                state.CreateUnion(bind_data.k, idata.input.allocator);
             }
-            u.update(a_sketch);
 
-            *state.sketch = u.get_result(datasketches::target_hll_type::HLL_4);
+            state.UnionSerialized(a_data, bind_data.k, idata.input.allocator);
         }
 
         template <class INPUT_TYPE, class STATE, class OP>
         static void ConstantOperation(STATE &state, const INPUT_TYPE &input, AggregateUnaryInput &unary_input,
                                     idx_t count) {
-            for (idx_t i = 0; i < count; i++) {
+            // The sketch ignores duplicates, so a single update is the same as count updates.
+            if (count > 0) {
                 Operation<INPUT_TYPE, STATE, OP>(state, input, unary_input);
             }
         }
@@ -901,35 +2246,38 @@ unique_ptr<FunctionData> DSCPCBind(ClientContext &context, AggregateFunction &fu
         static void Combine(const STATE &source, STATE &target,
                             AggregateInputData &aggr_input_data)
         {
-            if (!target.sketch)
+            if (!source.sketch_union)
             {
-                target.CreateSketch(source);
+                return;
             }
-            else
+            if (!target.sketch_union)
             {
-                datasketches::hll_union u(target.sketch->get_lg_config_k());
-                if(source.sketch) {
-                    u.update(*source.sketch);
+                if (CanTakeSource(aggr_input_data))
+                {
+                    target.MoveFrom(const_cast<STATE &>(source), aggr_input_data.allocator);
+                    return;
                 }
-                u.update(*target.sketch);
-
-                *target.sketch = u.get_result(datasketches::target_hll_type::HLL_4);
+                auto &bind_data = aggr_input_data.bind_data->template Cast<BIND_DATA_TYPE>();
+                target.CreateUnion(bind_data.k, aggr_input_data.allocator);
             }
+            target.sketch_union->update(source.sketch_union->get_result(datasketches::target_hll_type::HLL_8));
+            target.CombineRegisters(source, aggr_input_data.allocator);
         }
 
         template <class T, class STATE>
         static void Finalize(STATE &state, T &target,
                              AggregateFinalizeData &finalize_data)
         {
-            if (!state.sketch)
+            if (!state.sketch_union)
             {
                 finalize_data.ReturnNull();
             }
             else
             {
-                auto serialized_data = state.sketch->serialize_updatable();
-                auto sketch_string = std::string(serialized_data.begin(), serialized_data.end());
-                target = StringVector::AddStringOrBlob(finalize_data.result, sketch_string);
+                auto &bind_data = finalize_data.input.bind_data->template Cast<BIND_DATA_TYPE>();
+                state.FlushRegisters();
+                target = DSSerializeHLL(finalize_data.result, state.sketch_union->get_result(bind_data.target_type),
+                                        bind_data);
             }
         }
     };
@@ -943,134 +2291,467 @@ unique_ptr<FunctionData> DSCPCBind(ClientContext &context, AggregateFunction &fu
                               const A_TYPE &a_data,
                               AggregateUnaryInput &idata)
         {
-            auto &bind_data = idata.input.bind_data->template Cast<BIND_DATA_TYPE>();
+            if (!state.sketch_union)
+            {
+                auto &bind_data = idata.input.bind_data->template Cast<BIND_DATA_TYPE>();
+                state.CreateUnion(bind_data.k, idata.input.allocator);
+            }
 
-            if (!state.sketch)
+            state.sketch_union->update(state.deserialize_sketch(a_data));
+        }
+
+        template <class INPUT_TYPE, class STATE, class OP>
+        static void ConstantOperation(STATE &state, const INPUT_TYPE &input, AggregateUnaryInput &unary_input,
+                                    idx_t count) {
+            // The sketch ignores duplicates, so a single update is the same as count updates.
+            if (count > 0) {
+                Operation<INPUT_TYPE, STATE, OP>(state, input, unary_input);
+            }
+        }
+
+        template <class STATE, class OP>
+        static void Combine(const STATE &source, STATE &target,
+                            AggregateInputData &aggr_input_data)
+        {
+            if (!source.sketch_union)
+            {
+                return;
+            }
+            if (!target.sketch_union)
             {
-                state.CreateSketch(bind_data.k);
+                if (CanTakeSource(aggr_input_data))
+                {
+                    target.MoveFrom(const_cast<STATE &>(source), aggr_input_data.allocator);
+                    return;
+                }
+                auto &bind_data = aggr_input_data.bind_data->template Cast<BIND_DATA_TYPE>();
+                target.CreateUnion(bind_data.k, aggr_input_data.allocator);
             }
+            target.sketch_union->update(source.sketch_union->get_result());
+        }
 
-            auto a_sketch = state.deserialize_sketch(a_data);
-            datasketches::cpc_union u(bind_data.k);
-            if(state.sketch) {
-                u.update(*state.sketch);
+        template <class T, class STATE>
+        static void Finalize(STATE &state, T &target,
+                             AggregateFinalizeData &finalize_data)
+        {
+            if (!state.sketch_union)
+            {
+                finalize_data.ReturnNull();
             }
-            u.update(a_sketch);
+            else
+            {
+                target = DSSerializeSketch(finalize_data.result, state.sketch_union->get_result());
+            }
+        }
+    };
 
-            *state.sketch = u.get_result();
+    template <class BIND_DATA_TYPE>
+    struct DSCPCCreateOperation : DSSketchOperationBase
+    {
+        template <class A_TYPE, class STATE, class OP>
+        static void Operation(STATE &state,
+                              const A_TYPE &a_data,
+                              AggregateUnaryInput &idata)
+        {
+            auto &bind_data = idata.input.bind_data->template Cast<BIND_DATA_TYPE>();
+            DSCountingSketchStateUpdate(state, bind_data.k, idata.input.allocator, a_data);
         }
 
         template <class INPUT_TYPE, class STATE, class OP>
         static void ConstantOperation(STATE &state, const INPUT_TYPE &input, AggregateUnaryInput &unary_input,
                                     idx_t count) {
-            for (idx_t i = 0; i < count; i++) {
+            // The sketch ignores duplicates, so a single update is the same as count updates.
+            if (count > 0) {
                 Operation<INPUT_TYPE, STATE, OP>(state, input, unary_input);
             }
         }
 
+
         template <class STATE, class OP>
         static void Combine(const STATE &source, STATE &target,
                             AggregateInputData &aggr_input_data)
         {
-            if (!target.sketch)
+            // Buffered keys of the source are added like new values.
+            auto &bind_data = aggr_input_data.bind_data->template Cast<BIND_DATA_TYPE>();
+            for (idx_t i = 0; i < source.small_count; i++)
             {
-                target.CreateSketch(source);
+                target.UpdateKey(source.small_keys[i], bind_data.k, aggr_input_data.allocator);
             }
-            else
+            if (!source.sketch && !source.sketch_union)
             {
-                datasketches::cpc_union u(target.sketch->get_lg_k());
-                if(source.sketch) {
-                    u.update(*source.sketch);
-                }
-                u.update(*target.sketch);
-                *target.sketch = u.get_result();
+                return;
+            }
+            if (!target.sketch && !target.sketch_union && CanTakeSource(aggr_input_data))
+            {
+                target.MoveFrom(const_cast<STATE &>(source), aggr_input_data.allocator);
+                return;
+            }
+
+            // The thread partials are accumulated in a union that lives until Finalize.
+            if (!target.sketch_union)
+            {
+                target.CreateUnion(bind_data.k, aggr_input_data.allocator);
+            }
+            if (source.sketch)
+            {
+                target.sketch_union->update(*source.sketch);
+            }
+            if (source.sketch_union)
+            {
+                target.sketch_union->update(source.sketch_union->get_result());
             }
         }
 
+
         template <class T, class STATE>
         static void Finalize(STATE &state, T &target,
                              AggregateFinalizeData &finalize_data)
         {
-            if (!state.sketch)
+            auto &bind_data = finalize_data.input.bind_data->template Cast<BIND_DATA_TYPE>();
+            if (state.sketch_union)
             {
-                finalize_data.ReturnNull();
+                if (state.sketch)
+                {
+                    state.sketch_union->update(*state.sketch);
+                }
+                else if (state.small_count > 0)
+                {
+                    state.sketch_union->update(state.SmallBufferSketch(bind_data.k));
+                }
+                target = DSSerializeSketch(finalize_data.result, state.sketch_union->get_result());
+            }
+            else if (state.sketch)
+            {
+                target = DSSerializeSketch(finalize_data.result, *state.sketch);
+            }
+            else if (state.small_count > 0)
+            {
+                // A group that never filled the buffer still gets a standard sketch.
+                target = DSSerializeSketch(finalize_data.result, state.SmallBufferSketch(bind_data.k));
             }
             else
             {
-                auto serialized_data = state.sketch->serialize();
-                auto sketch_string = std::string(serialized_data.begin(), serialized_data.end());
-                target = StringVector::AddStringOrBlob(finalize_data.result, sketch_string);
+                finalize_data.ReturnNull();
+            }
+        }
+    };
+
+    // Create operation for ENUM input to the distinct counting sketches. The ordinals
+    // are resolved to the member strings cached in the bind data, so the sketches are
+    // the same as the ones built from the VARCHAR values.
+    template <class BIND_DATA_TYPE, class CREATE_OPERATION>
+    struct DSEnumCreateOperation : CREATE_OPERATION
+    {
+        template <class A_TYPE, class STATE, class OP>
+        static void Operation(STATE &state,
+                              const A_TYPE &a_data,
+                              AggregateUnaryInput &idata)
+        {
+            auto &bind_data = idata.input.bind_data->template Cast<BIND_DATA_TYPE>();
+            if (!state.sketch)
+            {
+                state.CreateSketch(bind_data.k, idata.input.allocator);
+            }
+
+            auto &member = bind_data.members[a_data];
+            state.sketch->update(member.data(), member.size());
+        }
+
+        template <class INPUT_TYPE, class STATE, class OP>
+        static void ConstantOperation(STATE &state, const INPUT_TYPE &input, AggregateUnaryInput &unary_input,
+                                    idx_t count) {
+            // The sketch ignores duplicates, so a single update is the same as count updates.
+            if (count > 0) {
+                Operation<INPUT_TYPE, STATE, OP>(state, input, unary_input);
+            }
+        }
+    };
+
+    // Both distinct counting sketches ignore repeated values, so a value that was
+    // already fed to the sketch from the current vector does not need to be hashed
+    // again. Only narrow integers are filtered, exactly with a bitmap: for wider
+    // values the check would cost about as much as the hash it saves on
+    // high-cardinality columns, so they pass through.
+    template <class T>
+    class DSRepeatFilter
+    {
+    public:
+        // Returns true if the value was already passed to this filter.
+        inline bool Seen(const T &value)
+        {
+            if constexpr (UsesBitmap()) {
+                auto slot = static_cast<std::make_unsigned_t<T>>(value);
+                if (seen.test(slot)) {
+                    return true;
+                }
+                seen.set(slot);
+                return false;
+            } else {
+                return false;
+            }
+        }
+
+    private:
+        static constexpr bool UsesBitmap()
+        {
+            return std::is_integral_v<T> && sizeof(T) <= 2;
+        }
+
+        static constexpr size_t BitmapSize()
+        {
+            if constexpr (UsesBitmap()) {
+                return size_t(1) << (8 * sizeof(T));
+            } else {
+                return 1;
+            }
+        }
+
+        std::bitset<BitmapSize()> seen;
+    };
+
+    // The indexes seen in one vector, in a hash table on the stack that is sized for
+    // the rows of the vector. Finding the repeated dictionary entries or enum members
+    // of a vector costs the same however large the dictionary or enum is.
+    class DSIndexSet
+    {
+    public:
+        explicit DSIndexSet(idx_t count)
+        {
+            D_ASSERT(count <= STANDARD_VECTOR_SIZE);
+            while (capacity < 2 * count)
+            {
+                capacity <<= 1;
+                shift--;
+            }
+            std::fill_n(slots, capacity, EMPTY);
+        }
+
+        // Returns true if the index was not in the set yet.
+        inline bool Insert(idx_t index)
+        {
+            auto slot = (index * 0x9E3779B97F4A7C15ULL) >> shift;
+            while (slots[slot] != EMPTY)
+            {
+                if (slots[slot] == index)
+                {
+                    return false;
+                }
+                slot = (slot + 1) & (capacity - 1);
+            }
+            slots[slot] = index;
+            return true;
+        }
+
+    private:
+        static constexpr idx_t EMPTY = ~idx_t(0);
+        static constexpr idx_t MIN_CAPACITY = 16;
+
+        idx_t slots[std::max<idx_t>(MIN_CAPACITY, 2 * STANDARD_VECTOR_SIZE)];
+        idx_t capacity = MIN_CAPACITY;
+        uint8_t shift = 60;
+    };
+
+    // Largest dictionary that is read by entry instead of by row.
+    static constexpr idx_t DS_MAX_DEDUPLICATED_DICTIONARY_SIZE = 1 << 20;
+
+    // Feed each dictionary entry referenced by a dictionary vector to the sketch once,
+    // in the order of first reference. Because the distinct counting sketches ignore
+    // duplicates this is the same as feeding every row, but each distinct string is
+    // hashed once per vector instead of once per row.
+    template <class STATE, class INPUT_TYPE, class BIND_DATA_TYPE>
+    static void DSCountingSketchDictionaryUpdate(STATE &state, BIND_DATA_TYPE &bind_data, ArenaAllocator &arena,
+                                                 Vector &input, idx_t dictionary_size, idx_t count)
+    {
+        auto &dictionary = DictionaryVector::Child(input);
+        auto &sel = DictionaryVector::SelVector(input);
+
+        UnifiedVectorFormat ddata;
+        dictionary.ToUnifiedFormat(dictionary_size, ddata);
+        auto values = UnifiedVectorFormat::GetData<INPUT_TYPE>(ddata);
+        DSIndexSet seen(count);
+        for (idx_t i = 0; i < count; i++)
+        {
+            auto entry = sel.get_index(i);
+            if (!seen.Insert(entry))
+            {
+                continue;
+            }
+            auto idx = ddata.sel->get_index(entry);
+            if (!ddata.validity.RowIsValid(idx))
+            {
+                continue;
+            }
+            DSCountingSketchStateUpdate(state, bind_data.k, arena, values[idx]);
+        }
+    }
+
+    // Ungrouped update for the HLL and CPC create aggregates, this is used in place of
+    // calling Operation() once per row. The bind data and the sketch are resolved once
+    // per vector and the values are then fed to the sketch in a tight loop.
+    template <class STATE, class INPUT_TYPE, class BIND_DATA_TYPE>
+    static void DSCountingSketchSimpleUpdate(Vector inputs[], AggregateInputData &aggr_input_data, idx_t input_count,
+                                             data_ptr_t state_p, idx_t count)
+    {
+        D_ASSERT(input_count == 1);
+        auto &state = *reinterpret_cast<STATE *>(state_p);
+        auto &bind_data = aggr_input_data.bind_data->template Cast<BIND_DATA_TYPE>();
+
+        auto &input = inputs[0];
+        if (input.GetVectorType() == VectorType::CONSTANT_VECTOR)
+        {
+            // The sketch ignores duplicates, a constant vector needs a single update.
+            if (count == 0 || ConstantVector::IsNull(input))
+            {
+                return;
+            }
+            DSCountingSketchStateUpdate(state, bind_data.k, aggr_input_data.allocator,
+                                        *ConstantVector::GetData<INPUT_TYPE>(input));
+            return;
+        }
+        if (input.GetVectorType() == VectorType::DICTIONARY_VECTOR)
+        {
+            auto dictionary_size = DictionaryVector::DictionarySize(input);
+            if (dictionary_size.IsValid() && dictionary_size.GetIndex() <= DS_MAX_DEDUPLICATED_DICTIONARY_SIZE)
+            {
+                DSCountingSketchDictionaryUpdate<STATE, INPUT_TYPE>(state, bind_data, aggr_input_data.allocator, input,
+                                                                    dictionary_size.GetIndex(), count);
+                return;
+            }
+        }
+
+        UnifiedVectorFormat idata;
+        input.ToUnifiedFormat(count, idata);
+        auto values = UnifiedVectorFormat::GetData<INPUT_TYPE>(idata);
+
+        if (idata.validity.AllValid())
+        {
+            DSRepeatFilter<INPUT_TYPE> filter;
+            idx_t i = 0;
+            // The values go to the small buffer until the sketch is built.
+            for (; i < count && !state.sketch; i++)
+            {
+                auto &value = values[idata.sel->get_index(i)];
+                if (!filter.Seen(value))
+                {
+                    DSCountingSketchStateUpdate(state, bind_data.k, aggr_input_data.allocator, value);
+                }
+            }
+            if (i == count)
+            {
+                return;
+            }
+            auto &sketch = *state.sketch;
+            for (; i < count; i++)
+            {
+                auto &value = values[idata.sel->get_index(i)];
+                if (!filter.Seen(value))
+                {
+                    DSCountingSketchUpdate(sketch, value);
+                }
+            }
+            return;
+        }
+
+        DSRepeatFilter<INPUT_TYPE> filter;
+        for (idx_t i = 0; i < count; i++)
+        {
+            auto idx = idata.sel->get_index(i);
+            if (!idata.validity.RowIsValid(idx) || filter.Seen(values[idx]))
+            {
+                continue;
             }
+            DSCountingSketchStateUpdate(state, bind_data.k, aggr_input_data.allocator, values[idx]);
         }
-    };
+    }
 
-    template <class BIND_DATA_TYPE>
-    struct DSCPCCreateOperation : DSSketchOperationBase
+    // Ungrouped update for the quantile create aggregates, this is used in place of
+    // calling Operation() once per row. The bind data and the sketch are resolved once
+    // per vector and the items are then fed to the sketch in a tight loop, in the
+    // order of the vector. TDigest collects the items in its own buffer and merges
+    // it when it is full, keeping the order keeps its results the same.
+    template <class STATE, class INPUT_TYPE, class BIND_DATA_TYPE>
+    static void DSQuantilesSimpleUpdate(Vector inputs[], AggregateInputData &aggr_input_data, idx_t input_count,
+                                        data_ptr_t state_p, idx_t count)
     {
-        template <class A_TYPE, class STATE, class OP>
-        static void Operation(STATE &state,
-                              const A_TYPE &a_data,
-                              AggregateUnaryInput &idata)
+        D_ASSERT(input_count == 1);
+        auto &state = *reinterpret_cast<STATE *>(state_p);
+        auto &bind_data = aggr_input_data.bind_data->template Cast<BIND_DATA_TYPE>();
+
+        UnifiedVectorFormat idata;
+        inputs[0].ToUnifiedFormat(count, idata);
+        auto values = UnifiedVectorFormat::GetData<INPUT_TYPE>(idata);
+
+        idx_t i = 0;
+        // The items go to the small buffer until the sketch is built.
+        for (; i < count && !state.sketch; i++)
         {
-            if (!state.sketch)
+            auto idx = idata.sel->get_index(i);
+            if (idata.validity.RowIsValid(idx))
             {
-                auto &bind_data = idata.input.bind_data->template Cast<BIND_DATA_TYPE>();
-                state.CreateSketch(bind_data.k);
-            }
-
-            if constexpr (std::is_same_v<A_TYPE, duckdb::string_t>) {
-                state.sketch->update(a_data.GetData(), a_data.GetSize());
-            } else {
-                state.sketch->update(a_data);
+                state.Update(values[idx], bind_data.k, aggr_input_data.allocator);
             }
         }
-
-        template <class INPUT_TYPE, class STATE, class OP>
-        static void ConstantOperation(STATE &state, const INPUT_TYPE &input, AggregateUnaryInput &unary_input,
-                                    idx_t count) {
-            for (idx_t i = 0; i < count; i++) {
-                Operation<INPUT_TYPE, STATE, OP>(state, input, unary_input);
-            }
+        if (i == count)
+        {
+            return;
         }
 
-
-        template <class STATE, class OP>
-        static void Combine(const STATE &source, STATE &target,
-                            AggregateInputData &aggr_input_data)
+        auto &sketch = *state.sketch;
+        if (idata.validity.AllValid())
         {
-            if (!target.sketch)
+            for (; i < count; i++)
             {
-                target.CreateSketch(source);
+                sketch.update(values[idata.sel->get_index(i)]);
             }
-            else
+            return;
+        }
+        for (; i < count; i++)
+        {
+            auto idx = idata.sel->get_index(i);
+            if (idata.validity.RowIsValid(idx))
             {
-                datasketches::cpc_union u(target.sketch->get_lg_k());
-                u.update(*target.sketch);
-                if(source.sketch) {
-                    u.update(*source.sketch);
-                }
-                *target.sketch = u.get_result();
+                sketch.update(values[idx]);
             }
         }
+    }
 
+    // Ungrouped update for ENUM input to the HLL and CPC create aggregates. Each row is
+    // a lookup of its member string in the bind data, and each member referenced by
+    // the vector is fed to the sketch once.
+    template <class STATE, class ORDINAL_TYPE, class BIND_DATA_TYPE>
+    static void DSCountingSketchEnumSimpleUpdate(Vector inputs[], AggregateInputData &aggr_input_data, idx_t input_count,
+                                                 data_ptr_t state_p, idx_t count)
+    {
+        D_ASSERT(input_count == 1);
+        auto &state = *reinterpret_cast<STATE *>(state_p);
+        auto &bind_data = aggr_input_data.bind_data->template Cast<BIND_DATA_TYPE>();
+        auto &members = bind_data.members;
 
-        template <class T, class STATE>
-        static void Finalize(STATE &state, T &target,
-                             AggregateFinalizeData &finalize_data)
+        UnifiedVectorFormat idata;
+        inputs[0].ToUnifiedFormat(count, idata);
+        auto ordinals = UnifiedVectorFormat::GetData<ORDINAL_TYPE>(idata);
+
+        DSIndexSet seen(count);
+        for (idx_t i = 0; i < count; i++)
         {
-            if (!state.sketch)
+            auto idx = idata.sel->get_index(i);
+            if (!idata.validity.RowIsValid(idx))
             {
-                finalize_data.ReturnNull();
+                continue;
             }
-            else
+            auto ordinal = ordinals[idx];
+            if (!seen.Insert(ordinal))
+            {
+                continue;
+            }
+            if (!state.sketch)
             {
-                auto serialized_data = state.sketch->serialize();
-                auto sketch_string = std::string(serialized_data.begin(), serialized_data.end());
-                target = StringVector::AddStringOrBlob(finalize_data.result, sketch_string);
+                state.CreateSketch(bind_data.k, aggr_input_data.allocator);
             }
+            auto &member = members[ordinal];
+            state.sketch->update(member.data(), member.size());
         }
-    };
-
+    }
 
 
 
@@ -1089,13 +2770,33 @@ static inline void DSQuantilesis_empty(DataChunk &args, ExpressionState &state,
 
     
         
+                    const bool sketch_is_constant = sketch_vector.GetVectorType() == VectorType::CONSTANT_VECTOR;
+                    std::optional<datasketches::quantiles_sketch<T>> constant_sketch;
+                    
         UnaryExecutor::Execute
         <string_t,bool>
         (
         sketch_vector,result,args.size(),
-        [&](string_t sketch_data) {
+        [&](string_t sketch_data) -> bool {
+
+            
+                    {
+                        DSQuantilesHeader header;
+                        if (DSQuantilesReadHeader<T>(sketch_data.GetDataUnsafe(), sketch_data.GetSize(), header))
+                        {
+                            return header.empty;
+                        }
+                    }
+                    
 
-            auto sketch = datasketches::quantiles_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize());
+                    std::optional<datasketches::quantiles_sketch<T>> row_sketch;
+                    auto &sketch_holder = sketch_is_constant ? constant_sketch : row_sketch;
+                    if (!sketch_holder)
+                    {
+                        sketch_holder.emplace(datasketches::quantiles_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize()));
+                    }
+                    auto &sketch = *sketch_holder;
+                    
 return sketch.is_empty();
         });
 
@@ -1116,13 +2817,33 @@ static inline void DSQuantilesk(DataChunk &args, ExpressionState &state, Vector
 
     
         
+                    const bool sketch_is_constant = sketch_vector.GetVectorType() == VectorType::CONSTANT_VECTOR;
+                    std::optional<datasketches::quantiles_sketch<T>> constant_sketch;
+                    
         UnaryExecutor::Execute
         <string_t,uint16_t>
         (
         sketch_vector,result,args.size(),
-        [&](string_t sketch_data) {
+        [&](string_t sketch_data) -> uint16_t {
+
+            
+                    {
+                        DSQuantilesHeader header;
+                        if (DSQuantilesReadHeader<T>(sketch_data.GetDataUnsafe(), sketch_data.GetSize(), header))
+                        {
+                            return header.k;
+                        }
+                    }
+                    
 
-            auto sketch = datasketches::quantiles_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize());
+                    std::optional<datasketches::quantiles_sketch<T>> row_sketch;
+                    auto &sketch_holder = sketch_is_constant ? constant_sketch : row_sketch;
+                    if (!sketch_holder)
+                    {
+                        sketch_holder.emplace(datasketches::quantiles_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize()));
+                    }
+                    auto &sketch = *sketch_holder;
+                    
 return sketch.get_k();
         });
 
@@ -1145,6 +2866,10 @@ static inline void DSQuantilescdf(DataChunk &args, ExpressionState &state, Vecto
 
     
         
+                    const bool sketch_is_constant = sketch_vector.GetVectorType() == VectorType::CONSTANT_VECTOR;
+                    std::optional<datasketches::quantiles_sketch<T>> constant_sketch;
+                    
+
                     UnifiedVectorFormat unified_split_points;
                     split_points_vector.ToUnifiedFormat(args.size(), unified_split_points);
 
@@ -1164,7 +2889,15 @@ static inline void DSQuantilescdf(DataChunk &args, ExpressionState &state, Vecto
         sketch_vector,split_points_vector,inclusive_vector,result,args.size(),
         [&](string_t sketch_data,list_entry_t split_points_data,bool inclusive_data) {
 
-            auto sketch = datasketches::quantiles_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize());
+            
+                    std::optional<datasketches::quantiles_sketch<T>> row_sketch;
+                    auto &sketch_holder = sketch_is_constant ? constant_sketch : row_sketch;
+                    if (!sketch_holder)
+                    {
+                        sketch_holder.emplace(datasketches::quantiles_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize()));
+                    }
+                    auto &sketch = *sketch_holder;
+                    
 
                     T *passing_points = (T *)malloc(sizeof(T) * split_points_data.length);
                     for (idx_t i = 0; i < split_points_data.length; i++)
@@ -1212,6 +2945,10 @@ static inline void DSQuantilespmf(DataChunk &args, ExpressionState &state, Vecto
 
     
         
+                    const bool sketch_is_constant = sketch_vector.GetVectorType() == VectorType::CONSTANT_VECTOR;
+                    std::optional<datasketches::quantiles_sketch<T>> constant_sketch;
+                    
+
                     UnifiedVectorFormat unified_split_points;
                     split_points_vector.ToUnifiedFormat(args.size(), unified_split_points);
 
@@ -1231,7 +2968,15 @@ static inline void DSQuantilespmf(DataChunk &args, ExpressionState &state, Vecto
         sketch_vector,split_points_vector,inclusive_vector,result,args.size(),
         [&](string_t sketch_data,list_entry_t split_points_data,bool inclusive_data) {
 
-            auto sketch = datasketches::quantiles_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize());
+            
+                    std::optional<datasketches::quantiles_sketch<T>> row_sketch;
+                    auto &sketch_holder = sketch_is_constant ? constant_sketch : row_sketch;
+                    if (!sketch_holder)
+                    {
+                        sketch_holder.emplace(datasketches::quantiles_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize()));
+                    }
+                    auto &sketch = *sketch_holder;
+                    
 
                     T *passing_points = (T *)malloc(sizeof(T) * split_points_data.length);
                     for (idx_t i = 0; i < split_points_data.length; i++)
@@ -1279,13 +3024,24 @@ static inline void DSQuantilesnormalized_rank_error(DataChunk &args, ExpressionS
 
     
         
+                    const bool sketch_is_constant = sketch_vector.GetVectorType() == VectorType::CONSTANT_VECTOR;
+                    std::optional<datasketches::quantiles_sketch<T>> constant_sketch;
+                    
         BinaryExecutor::Execute
         <string_t,bool,double>
         (
         sketch_vector,is_pmf_vector,result,args.size(),
         [&](string_t sketch_data,bool is_pmf_data) {
 
-            auto sketch = datasketches::quantiles_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize());
+            
+                    std::optional<datasketches::quantiles_sketch<T>> row_sketch;
+                    auto &sketch_holder = sketch_is_constant ? constant_sketch : row_sketch;
+                    if (!sketch_holder)
+                    {
+                        sketch_holder.emplace(datasketches::quantiles_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize()));
+                    }
+                    auto &sketch = *sketch_holder;
+                    
 return sketch.get_normalized_rank_error(is_pmf_data);
         });
 
@@ -1308,13 +3064,24 @@ static inline void DSQuantilesdescribe(DataChunk &args, ExpressionState &state,
 
     
         
+                    const bool sketch_is_constant = sketch_vector.GetVectorType() == VectorType::CONSTANT_VECTOR;
+                    std::optional<datasketches::quantiles_sketch<T>> constant_sketch;
+                    
         TernaryExecutor::Execute
         <string_t,bool,bool,string_t>
         (
         sketch_vector,include_levels_vector,include_items_vector,result,args.size(),
         [&](string_t sketch_data,bool include_levels_data,bool include_items_data) {
 
-            auto sketch = datasketches::quantiles_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize());
+            
+                    std::optional<datasketches::quantiles_sketch<T>> row_sketch;
+                    auto &sketch_holder = sketch_is_constant ? constant_sketch : row_sketch;
+                    if (!sketch_holder)
+                    {
+                        sketch_holder.emplace(datasketches::quantiles_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize()));
+                    }
+                    auto &sketch = *sketch_holder;
+                    
 return StringVector::AddString(result, sketch.to_string(include_levels_data, include_items_data));
         });
 
@@ -1337,13 +3104,24 @@ static inline void DSQuantilesrank(DataChunk &args, ExpressionState &state, Vect
 
     
         
+                    const bool sketch_is_constant = sketch_vector.GetVectorType() == VectorType::CONSTANT_VECTOR;
+                    std::optional<datasketches::quantiles_sketch<T>> constant_sketch;
+                    
         TernaryExecutor::Execute
         <string_t,T,bool,double>
         (
         sketch_vector,item_vector,inclusive_vector,result,args.size(),
         [&](string_t sketch_data,T item_data,bool inclusive_data) {
 
-            auto sketch = datasketches::quantiles_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize());
+            
+                    std::optional<datasketches::quantiles_sketch<T>> row_sketch;
+                    auto &sketch_holder = sketch_is_constant ? constant_sketch : row_sketch;
+                    if (!sketch_holder)
+                    {
+                        sketch_holder.emplace(datasketches::quantiles_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize()));
+                    }
+                    auto &sketch = *sketch_holder;
+                    
 return sketch.get_rank(item_data, inclusive_data);
         });
 
@@ -1366,13 +3144,24 @@ static inline void DSQuantilesquantile(DataChunk &args, ExpressionState &state,
 
     
         
+                    const bool sketch_is_constant = sketch_vector.GetVectorType() == VectorType::CONSTANT_VECTOR;
+                    std::optional<datasketches::quantiles_sketch<T>> constant_sketch;
+                    
         TernaryExecutor::Execute
         <string_t,double,bool,T>
         (
         sketch_vector,rank_vector,inclusive_vector,result,args.size(),
         [&](string_t sketch_data,double rank_data,bool inclusive_data) {
 
-            auto sketch = datasketches::quantiles_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize());
+            
+                    std::optional<datasketches::quantiles_sketch<T>> row_sketch;
+                    auto &sketch_holder = sketch_is_constant ? constant_sketch : row_sketch;
+                    if (!sketch_holder)
+                    {
+                        sketch_holder.emplace(datasketches::quantiles_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize()));
+                    }
+                    auto &sketch = *sketch_holder;
+                    
 return sketch.get_quantile(rank_data, inclusive_data);
         });
 
@@ -1393,13 +3182,33 @@ static inline void DSQuantilesn(DataChunk &args, ExpressionState &state, Vector
 
     
         
+                    const bool sketch_is_constant = sketch_vector.GetVectorType() == VectorType::CONSTANT_VECTOR;
+                    std::optional<datasketches::quantiles_sketch<T>> constant_sketch;
+                    
         UnaryExecutor::Execute
         <string_t,uint64_t>
         (
         sketch_vector,result,args.size(),
-        [&](string_t sketch_data) {
+        [&](string_t sketch_data) -> uint64_t {
+
+            
+                    {
+                        DSQuantilesHeader header;
+                        if (DSQuantilesReadHeader<T>(sketch_data.GetDataUnsafe(), sketch_data.GetSize(), header))
+                        {
+                            return header.n;
+                        }
+                    }
+                    
 
-            auto sketch = datasketches::quantiles_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize());
+                    std::optional<datasketches::quantiles_sketch<T>> row_sketch;
+                    auto &sketch_holder = sketch_is_constant ? constant_sketch : row_sketch;
+                    if (!sketch_holder)
+                    {
+                        sketch_holder.emplace(datasketches::quantiles_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize()));
+                    }
+                    auto &sketch = *sketch_holder;
+                    
 return sketch.get_n();
         });
 
@@ -1420,13 +3229,33 @@ static inline void DSQuantilesis_estimation_mode(DataChunk &args, ExpressionStat
 
     
         
+                    const bool sketch_is_constant = sketch_vector.GetVectorType() == VectorType::CONSTANT_VECTOR;
+                    std::optional<datasketches::quantiles_sketch<T>> constant_sketch;
+                    
         UnaryExecutor::Execute
         <string_t,bool>
         (
         sketch_vector,result,args.size(),
-        [&](string_t sketch_data) {
+        [&](string_t sketch_data) -> bool {
+
+            
+                    {
+                        DSQuantilesHeader header;
+                        if (DSQuantilesReadHeader<T>(sketch_data.GetDataUnsafe(), sketch_data.GetSize(), header))
+                        {
+                            return header.estimation_mode;
+                        }
+                    }
+                    
 
-            auto sketch = datasketches::quantiles_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize());
+                    std::optional<datasketches::quantiles_sketch<T>> row_sketch;
+                    auto &sketch_holder = sketch_is_constant ? constant_sketch : row_sketch;
+                    if (!sketch_holder)
+                    {
+                        sketch_holder.emplace(datasketches::quantiles_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize()));
+                    }
+                    auto &sketch = *sketch_holder;
+                    
 return sketch.is_estimation_mode();
         });
 
@@ -1447,13 +3276,33 @@ static inline void DSQuantilesnum_retained(DataChunk &args, ExpressionState &sta
 
     
         
+                    const bool sketch_is_constant = sketch_vector.GetVectorType() == VectorType::CONSTANT_VECTOR;
+                    std::optional<datasketches::quantiles_sketch<T>> constant_sketch;
+                    
         UnaryExecutor::Execute
         <string_t,uint64_t>
         (
         sketch_vector,result,args.size(),
-        [&](string_t sketch_data) {
+        [&](string_t sketch_data) -> uint64_t {
+
+            
+                    {
+                        DSQuantilesHeader header;
+                        if (DSQuantilesReadHeader<T>(sketch_data.GetDataUnsafe(), sketch_data.GetSize(), header))
+                        {
+                            return header.num_retained;
+                        }
+                    }
+                    
 
-            auto sketch = datasketches::quantiles_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize());
+                    std::optional<datasketches::quantiles_sketch<T>> row_sketch;
+                    auto &sketch_holder = sketch_is_constant ? constant_sketch : row_sketch;
+                    if (!sketch_holder)
+                    {
+                        sketch_holder.emplace(datasketches::quantiles_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize()));
+                    }
+                    auto &sketch = *sketch_holder;
+                    
 return sketch.get_num_retained();
         });
 
@@ -1474,13 +3323,24 @@ static inline void DSQuantilesmin_item(DataChunk &args, ExpressionState &state,
 
     
         
+                    const bool sketch_is_constant = sketch_vector.GetVectorType() == VectorType::CONSTANT_VECTOR;
+                    std::optional<datasketches::quantiles_sketch<T>> constant_sketch;
+                    
         UnaryExecutor::Execute
         <string_t,T>
         (
         sketch_vector,result,args.size(),
         [&](string_t sketch_data) {
 
-            auto sketch = datasketches::quantiles_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize());
+            
+                    std::optional<datasketches::quantiles_sketch<T>> row_sketch;
+                    auto &sketch_holder = sketch_is_constant ? constant_sketch : row_sketch;
+                    if (!sketch_holder)
+                    {
+                        sketch_holder.emplace(datasketches::quantiles_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize()));
+                    }
+                    auto &sketch = *sketch_holder;
+                    
 return sketch.get_min_item();
         });
 
@@ -1501,13 +3361,24 @@ static inline void DSQuantilesmax_item(DataChunk &args, ExpressionState &state,
 
     
         
+                    const bool sketch_is_constant = sketch_vector.GetVectorType() == VectorType::CONSTANT_VECTOR;
+                    std::optional<datasketches::quantiles_sketch<T>> constant_sketch;
+                    
         UnaryExecutor::Execute
         <string_t,T>
         (
         sketch_vector,result,args.size(),
         [&](string_t sketch_data) {
 
-            auto sketch = datasketches::quantiles_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize());
+            
+                    std::optional<datasketches::quantiles_sketch<T>> row_sketch;
+                    auto &sketch_holder = sketch_is_constant ? constant_sketch : row_sketch;
+                    if (!sketch_holder)
+                    {
+                        sketch_holder.emplace(datasketches::quantiles_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize()));
+                    }
+                    auto &sketch = *sketch_holder;
+                    
 return sketch.get_max_item();
         });
 
@@ -1533,14 +3404,21 @@ return sketch.get_max_item();
     auto static DSQuantilesCreateAggregate(const LogicalType &type, const LogicalType &result_type) -> AggregateFunction
     {
         
-        return AggregateFunction::UnaryAggregateDestructor<DSQuantilesState<T>, T, string_t, DSQuantilesCreateOperation<DSQuantilesBindData>, AggregateDestructorType::LEGACY>(
+        auto fun = AggregateFunction::UnaryAggregateDestructor<DSQuantilesState<T>, T, string_t, DSQuantilesCreateOperation<DSQuantilesBindData>, AggregateDestructorType::LEGACY>(
             type, result_type);
+        fun.simple_update = DSQuantilesSimpleUpdate<DSQuantilesState<T>, T, DSQuantilesBindData>;
+        return fun;
         
     }
 
+    
+    
+
 
   void LoadQuantilesSketch(ExtensionLoader &loader) {
 
+      
+
 
       
         std::unordered_map<LogicalTypeId, LogicalType> sketch_map_types;
@@ -2208,6 +4086,7 @@ return sketch.get_max_item();
                 sketch.AddFunction(fun);
             }
             //sketch.AddFunction(DSQuantilesCreateAggregate<int8_t>(LogicalType::TINYINT, sketch_map_types[LogicalTypeId::TINYINT]));
+            
             {
                 auto fun = DSQuantilesMergeAggregate<int8_t>(LogicalType::TINYINT, sketch_map_types[LogicalTypeId::TINYINT]);
                 fun.bind = DSQuantilesBind;
@@ -2224,6 +4103,7 @@ return sketch.get_max_item();
                 sketch.AddFunction(fun);
             }
             //sketch.AddFunction(DSQuantilesCreateAggregate<int16_t>(LogicalType::SMALLINT, sketch_map_types[LogicalTypeId::SMALLINT]));
+            
             {
                 auto fun = DSQuantilesMergeAggregate<int16_t>(LogicalType::SMALLINT, sketch_map_types[LogicalTypeId::SMALLINT]);
                 fun.bind = DSQuantilesBind;
@@ -2240,6 +4120,7 @@ return sketch.get_max_item();
                 sketch.AddFunction(fun);
             }
             //sketch.AddFunction(DSQuantilesCreateAggregate<int32_t>(LogicalType::INTEGER, sketch_map_types[LogicalTypeId::INTEGER]));
+            
             {
                 auto fun = DSQuantilesMergeAggregate<int32_t>(LogicalType::INTEGER, sketch_map_types[LogicalTypeId::INTEGER]);
                 fun.bind = DSQuantilesBind;
@@ -2256,6 +4137,7 @@ return sketch.get_max_item();
                 sketch.AddFunction(fun);
             }
             //sketch.AddFunction(DSQuantilesCreateAggregate<int64_t>(LogicalType::BIGINT, sketch_map_types[LogicalTypeId::BIGINT]));
+            
             {
                 auto fun = DSQuantilesMergeAggregate<int64_t>(LogicalType::BIGINT, sketch_map_types[LogicalTypeId::BIGINT]);
                 fun.bind = DSQuantilesBind;
@@ -2272,6 +4154,7 @@ return sketch.get_max_item();
                 sketch.AddFunction(fun);
             }
             //sketch.AddFunction(DSQuantilesCreateAggregate<float>(LogicalType::FLOAT, sketch_map_types[LogicalTypeId::FLOAT]));
+            
             {
                 auto fun = DSQuantilesMergeAggregate<float>(LogicalType::FLOAT, sketch_map_types[LogicalTypeId::FLOAT]);
                 fun.bind = DSQuantilesBind;
@@ -2288,6 +4171,7 @@ return sketch.get_max_item();
                 sketch.AddFunction(fun);
             }
             //sketch.AddFunction(DSQuantilesCreateAggregate<double>(LogicalType::DOUBLE, sketch_map_types[LogicalTypeId::DOUBLE]));
+            
             {
                 auto fun = DSQuantilesMergeAggregate<double>(LogicalType::DOUBLE, sketch_map_types[LogicalTypeId::DOUBLE]);
                 fun.bind = DSQuantilesBind;
@@ -2304,6 +4188,7 @@ return sketch.get_max_item();
                 sketch.AddFunction(fun);
             }
             //sketch.AddFunction(DSQuantilesCreateAggregate<uint8_t>(LogicalType::UTINYINT, sketch_map_types[LogicalTypeId::UTINYINT]));
+            
             {
                 auto fun = DSQuantilesMergeAggregate<uint8_t>(LogicalType::UTINYINT, sketch_map_types[LogicalTypeId::UTINYINT]);
                 fun.bind = DSQuantilesBind;
@@ -2320,6 +4205,7 @@ return sketch.get_max_item();
                 sketch.AddFunction(fun);
             }
             //sketch.AddFunction(DSQuantilesCreateAggregate<uint16_t>(LogicalType::USMALLINT, sketch_map_types[LogicalTypeId::USMALLINT]));
+            
             {
                 auto fun = DSQuantilesMergeAggregate<uint16_t>(LogicalType::USMALLINT, sketch_map_types[LogicalTypeId::USMALLINT]);
                 fun.bind = DSQuantilesBind;
@@ -2336,6 +4222,7 @@ return sketch.get_max_item();
                 sketch.AddFunction(fun);
             }
             //sketch.AddFunction(DSQuantilesCreateAggregate<uint32_t>(LogicalType::UINTEGER, sketch_map_types[LogicalTypeId::UINTEGER]));
+            
             {
                 auto fun = DSQuantilesMergeAggregate<uint32_t>(LogicalType::UINTEGER, sketch_map_types[LogicalTypeId::UINTEGER]);
                 fun.bind = DSQuantilesBind;
@@ -2352,6 +4239,7 @@ return sketch.get_max_item();
                 sketch.AddFunction(fun);
             }
             //sketch.AddFunction(DSQuantilesCreateAggregate<uint64_t>(LogicalType::UBIGINT, sketch_map_types[LogicalTypeId::UBIGINT]));
+            
             {
                 auto fun = DSQuantilesMergeAggregate<uint64_t>(LogicalType::UBIGINT, sketch_map_types[LogicalTypeId::UBIGINT]);
                 fun.bind = DSQuantilesBind;
@@ -2360,6 +4248,7 @@ return sketch.get_max_item();
             }
             //sketch.AddFunction(DSQuantilesMergeAggregate<uint64_t>(LogicalType::UBIGINT, sketch_map_types[LogicalTypeId::UBIGINT]));
         
+      
       CreateAggregateFunctionInfo sketch_info(sketch);
 
 
@@ -2394,13 +4283,33 @@ static inline void DSKLLis_empty(DataChunk &args, ExpressionState &state, Vector
 
     
         
+                    const bool sketch_is_constant = sketch_vector.GetVectorType() == VectorType::CONSTANT_VECTOR;
+                    std::optional<datasketches::kll_sketch<T>> constant_sketch;
+                    
         UnaryExecutor::Execute
         <string_t,bool>
         (
         sketch_vector,result,args.size(),
-        [&](string_t sketch_data) {
+        [&](string_t sketch_data) -> bool {
+
+            
+                    {
+                        DSKLLHeader header;
+                        if (DSKLLReadHeader<T>(sketch_data.GetDataUnsafe(), sketch_data.GetSize(), header))
+                        {
+                            return header.empty;
+                        }
+                    }
+                    
 
-            auto sketch = datasketches::kll_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize());
+                    std::optional<datasketches::kll_sketch<T>> row_sketch;
+                    auto &sketch_holder = sketch_is_constant ? constant_sketch : row_sketch;
+                    if (!sketch_holder)
+                    {
+                        sketch_holder.emplace(datasketches::kll_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize()));
+                    }
+                    auto &sketch = *sketch_holder;
+                    
 return sketch.is_empty();
         });
 
@@ -2421,13 +4330,33 @@ static inline void DSKLLk(DataChunk &args, ExpressionState &state, Vector &resul
 
     
         
+                    const bool sketch_is_constant = sketch_vector.GetVectorType() == VectorType::CONSTANT_VECTOR;
+                    std::optional<datasketches::kll_sketch<T>> constant_sketch;
+                    
         UnaryExecutor::Execute
         <string_t,uint16_t>
         (
         sketch_vector,result,args.size(),
-        [&](string_t sketch_data) {
+        [&](string_t sketch_data) -> uint16_t {
+
+            
+                    {
+                        DSKLLHeader header;
+                        if (DSKLLReadHeader<T>(sketch_data.GetDataUnsafe(), sketch_data.GetSize(), header))
+                        {
+                            return header.k;
+                        }
+                    }
+                    
 
-            auto sketch = datasketches::kll_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize());
+                    std::optional<datasketches::kll_sketch<T>> row_sketch;
+                    auto &sketch_holder = sketch_is_constant ? constant_sketch : row_sketch;
+                    if (!sketch_holder)
+                    {
+                        sketch_holder.emplace(datasketches::kll_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize()));
+                    }
+                    auto &sketch = *sketch_holder;
+                    
 return sketch.get_k();
         });
 
@@ -2450,6 +4379,10 @@ static inline void DSKLLcdf(DataChunk &args, ExpressionState &state, Vector &res
 
     
         
+                    const bool sketch_is_constant = sketch_vector.GetVectorType() == VectorType::CONSTANT_VECTOR;
+                    std::optional<datasketches::kll_sketch<T>> constant_sketch;
+                    
+
                     UnifiedVectorFormat unified_split_points;
                     split_points_vector.ToUnifiedFormat(args.size(), unified_split_points);
 
@@ -2469,7 +4402,15 @@ static inline void DSKLLcdf(DataChunk &args, ExpressionState &state, Vector &res
         sketch_vector,split_points_vector,inclusive_vector,result,args.size(),
         [&](string_t sketch_data,list_entry_t split_points_data,bool inclusive_data) {
 
-            auto sketch = datasketches::kll_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize());
+            
+                    std::optional<datasketches::kll_sketch<T>> row_sketch;
+                    auto &sketch_holder = sketch_is_constant ? constant_sketch : row_sketch;
+                    if (!sketch_holder)
+                    {
+                        sketch_holder.emplace(datasketches::kll_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize()));
+                    }
+                    auto &sketch = *sketch_holder;
+                    
 
                     T *passing_points = (T *)malloc(sizeof(T) * split_points_data.length);
                     for (idx_t i = 0; i < split_points_data.length; i++)
@@ -2517,6 +4458,10 @@ static inline void DSKLLpmf(DataChunk &args, ExpressionState &state, Vector &res
 
     
         
+                    const bool sketch_is_constant = sketch_vector.GetVectorType() == VectorType::CONSTANT_VECTOR;
+                    std::optional<datasketches::kll_sketch<T>> constant_sketch;
+                    
+
                     UnifiedVectorFormat unified_split_points;
                     split_points_vector.ToUnifiedFormat(args.size(), unified_split_points);
 
@@ -2536,7 +4481,15 @@ static inline void DSKLLpmf(DataChunk &args, ExpressionState &state, Vector &res
         sketch_vector,split_points_vector,inclusive_vector,result,args.size(),
         [&](string_t sketch_data,list_entry_t split_points_data,bool inclusive_data) {
 
-            auto sketch = datasketches::kll_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize());
+            
+                    std::optional<datasketches::kll_sketch<T>> row_sketch;
+                    auto &sketch_holder = sketch_is_constant ? constant_sketch : row_sketch;
+                    if (!sketch_holder)
+                    {
+                        sketch_holder.emplace(datasketches::kll_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize()));
+                    }
+                    auto &sketch = *sketch_holder;
+                    
 
                     T *passing_points = (T *)malloc(sizeof(T) * split_points_data.length);
                     for (idx_t i = 0; i < split_points_data.length; i++)
@@ -2584,13 +4537,24 @@ static inline void DSKLLnormalized_rank_error(DataChunk &args, ExpressionState &
 
     
         
+                    const bool sketch_is_constant = sketch_vector.GetVectorType() == VectorType::CONSTANT_VECTOR;
+                    std::optional<datasketches::kll_sketch<T>> constant_sketch;
+                    
         BinaryExecutor::Execute
         <string_t,bool,double>
         (
         sketch_vector,is_pmf_vector,result,args.size(),
         [&](string_t sketch_data,bool is_pmf_data) {
 
-            auto sketch = datasketches::kll_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize());
+            
+                    std::optional<datasketches::kll_sketch<T>> row_sketch;
+                    auto &sketch_holder = sketch_is_constant ? constant_sketch : row_sketch;
+                    if (!sketch_holder)
+                    {
+                        sketch_holder.emplace(datasketches::kll_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize()));
+                    }
+                    auto &sketch = *sketch_holder;
+                    
 return sketch.get_normalized_rank_error(is_pmf_data);
         });
 
@@ -2613,13 +4577,24 @@ static inline void DSKLLdescribe(DataChunk &args, ExpressionState &state, Vector
 
     
         
+                    const bool sketch_is_constant = sketch_vector.GetVectorType() == VectorType::CONSTANT_VECTOR;
+                    std::optional<datasketches::kll_sketch<T>> constant_sketch;
+                    
         TernaryExecutor::Execute
         <string_t,bool,bool,string_t>
         (
         sketch_vector,include_levels_vector,include_items_vector,result,args.size(),
         [&](string_t sketch_data,bool include_levels_data,bool include_items_data) {
 
-            auto sketch = datasketches::kll_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize());
+            
+                    std::optional<datasketches::kll_sketch<T>> row_sketch;
+                    auto &sketch_holder = sketch_is_constant ? constant_sketch : row_sketch;
+                    if (!sketch_holder)
+                    {
+                        sketch_holder.emplace(datasketches::kll_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize()));
+                    }
+                    auto &sketch = *sketch_holder;
+                    
 return StringVector::AddString(result, sketch.to_string(include_levels_data, include_items_data));
         });
 
@@ -2642,13 +4617,24 @@ static inline void DSKLLrank(DataChunk &args, ExpressionState &state, Vector &re
 
     
         
+                    const bool sketch_is_constant = sketch_vector.GetVectorType() == VectorType::CONSTANT_VECTOR;
+                    std::optional<datasketches::kll_sketch<T>> constant_sketch;
+                    
         TernaryExecutor::Execute
         <string_t,T,bool,double>
         (
         sketch_vector,item_vector,inclusive_vector,result,args.size(),
         [&](string_t sketch_data,T item_data,bool inclusive_data) {
 
-            auto sketch = datasketches::kll_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize());
+            
+                    std::optional<datasketches::kll_sketch<T>> row_sketch;
+                    auto &sketch_holder = sketch_is_constant ? constant_sketch : row_sketch;
+                    if (!sketch_holder)
+                    {
+                        sketch_holder.emplace(datasketches::kll_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize()));
+                    }
+                    auto &sketch = *sketch_holder;
+                    
 return sketch.get_rank(item_data, inclusive_data);
         });
 
@@ -2671,13 +4657,24 @@ static inline void DSKLLquantile(DataChunk &args, ExpressionState &state, Vector
 
     
         
+                    const bool sketch_is_constant = sketch_vector.GetVectorType() == VectorType::CONSTANT_VECTOR;
+                    std::optional<datasketches::kll_sketch<T>> constant_sketch;
+                    
         TernaryExecutor::Execute
         <string_t,double,bool,T>
         (
         sketch_vector,rank_vector,inclusive_vector,result,args.size(),
         [&](string_t sketch_data,double rank_data,bool inclusive_data) {
 
-            auto sketch = datasketches::kll_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize());
+            
+                    std::optional<datasketches::kll_sketch<T>> row_sketch;
+                    auto &sketch_holder = sketch_is_constant ? constant_sketch : row_sketch;
+                    if (!sketch_holder)
+                    {
+                        sketch_holder.emplace(datasketches::kll_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize()));
+                    }
+                    auto &sketch = *sketch_holder;
+                    
 return sketch.get_quantile(rank_data, inclusive_data);
         });
 
@@ -2698,13 +4695,33 @@ static inline void DSKLLn(DataChunk &args, ExpressionState &state, Vector &resul
 
     
         
+                    const bool sketch_is_constant = sketch_vector.GetVectorType() == VectorType::CONSTANT_VECTOR;
+                    std::optional<datasketches::kll_sketch<T>> constant_sketch;
+                    
         UnaryExecutor::Execute
         <string_t,uint64_t>
         (
         sketch_vector,result,args.size(),
-        [&](string_t sketch_data) {
+        [&](string_t sketch_data) -> uint64_t {
+
+            
+                    {
+                        DSKLLHeader header;
+                        if (DSKLLReadHeader<T>(sketch_data.GetDataUnsafe(), sketch_data.GetSize(), header))
+                        {
+                            return header.n;
+                        }
+                    }
+                    
 
-            auto sketch = datasketches::kll_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize());
+                    std::optional<datasketches::kll_sketch<T>> row_sketch;
+                    auto &sketch_holder = sketch_is_constant ? constant_sketch : row_sketch;
+                    if (!sketch_holder)
+                    {
+                        sketch_holder.emplace(datasketches::kll_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize()));
+                    }
+                    auto &sketch = *sketch_holder;
+                    
 return sketch.get_n();
         });
 
@@ -2725,13 +4742,33 @@ static inline void DSKLLis_estimation_mode(DataChunk &args, ExpressionState &sta
 
     
         
+                    const bool sketch_is_constant = sketch_vector.GetVectorType() == VectorType::CONSTANT_VECTOR;
+                    std::optional<datasketches::kll_sketch<T>> constant_sketch;
+                    
         UnaryExecutor::Execute
         <string_t,bool>
         (
         sketch_vector,result,args.size(),
-        [&](string_t sketch_data) {
+        [&](string_t sketch_data) -> bool {
+
+            
+                    {
+                        DSKLLHeader header;
+                        if (DSKLLReadHeader<T>(sketch_data.GetDataUnsafe(), sketch_data.GetSize(), header))
+                        {
+                            return header.estimation_mode;
+                        }
+                    }
+                    
 
-            auto sketch = datasketches::kll_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize());
+                    std::optional<datasketches::kll_sketch<T>> row_sketch;
+                    auto &sketch_holder = sketch_is_constant ? constant_sketch : row_sketch;
+                    if (!sketch_holder)
+                    {
+                        sketch_holder.emplace(datasketches::kll_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize()));
+                    }
+                    auto &sketch = *sketch_holder;
+                    
 return sketch.is_estimation_mode();
         });
 
@@ -2752,13 +4789,33 @@ static inline void DSKLLnum_retained(DataChunk &args, ExpressionState &state, Ve
 
     
         
+                    const bool sketch_is_constant = sketch_vector.GetVectorType() == VectorType::CONSTANT_VECTOR;
+                    std::optional<datasketches::kll_sketch<T>> constant_sketch;
+                    
         UnaryExecutor::Execute
         <string_t,uint64_t>
         (
         sketch_vector,result,args.size(),
-        [&](string_t sketch_data) {
+        [&](string_t sketch_data) -> uint64_t {
+
+            
+                    {
+                        DSKLLHeader header;
+                        if (DSKLLReadHeader<T>(sketch_data.GetDataUnsafe(), sketch_data.GetSize(), header))
+                        {
+                            return header.num_retained;
+                        }
+                    }
+                    
 
-            auto sketch = datasketches::kll_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize());
+                    std::optional<datasketches::kll_sketch<T>> row_sketch;
+                    auto &sketch_holder = sketch_is_constant ? constant_sketch : row_sketch;
+                    if (!sketch_holder)
+                    {
+                        sketch_holder.emplace(datasketches::kll_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize()));
+                    }
+                    auto &sketch = *sketch_holder;
+                    
 return sketch.get_num_retained();
         });
 
@@ -2779,13 +4836,24 @@ static inline void DSKLLmin_item(DataChunk &args, ExpressionState &state, Vector
 
     
         
+                    const bool sketch_is_constant = sketch_vector.GetVectorType() == VectorType::CONSTANT_VECTOR;
+                    std::optional<datasketches::kll_sketch<T>> constant_sketch;
+                    
         UnaryExecutor::Execute
         <string_t,T>
         (
         sketch_vector,result,args.size(),
         [&](string_t sketch_data) {
 
-            auto sketch = datasketches::kll_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize());
+            
+                    std::optional<datasketches::kll_sketch<T>> row_sketch;
+                    auto &sketch_holder = sketch_is_constant ? constant_sketch : row_sketch;
+                    if (!sketch_holder)
+                    {
+                        sketch_holder.emplace(datasketches::kll_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize()));
+                    }
+                    auto &sketch = *sketch_holder;
+                    
 return sketch.get_min_item();
         });
 
@@ -2806,13 +4874,24 @@ static inline void DSKLLmax_item(DataChunk &args, ExpressionState &state, Vector
 
     
         
+                    const bool sketch_is_constant = sketch_vector.GetVectorType() == VectorType::CONSTANT_VECTOR;
+                    std::optional<datasketches::kll_sketch<T>> constant_sketch;
+                    
         UnaryExecutor::Execute
         <string_t,T>
         (
         sketch_vector,result,args.size(),
         [&](string_t sketch_data) {
 
-            auto sketch = datasketches::kll_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize());
+            
+                    std::optional<datasketches::kll_sketch<T>> row_sketch;
+                    auto &sketch_holder = sketch_is_constant ? constant_sketch : row_sketch;
+                    if (!sketch_holder)
+                    {
+                        sketch_holder.emplace(datasketches::kll_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize()));
+                    }
+                    auto &sketch = *sketch_holder;
+                    
 return sketch.get_max_item();
         });
 
@@ -2838,14 +4917,31 @@ return sketch.get_max_item();
     auto static DSKLLCreateAggregate(const LogicalType &type, const LogicalType &result_type) -> AggregateFunction
     {
         
-        return AggregateFunction::UnaryAggregateDestructor<DSKLLState<T>, T, string_t, DSQuantilesCreateOperation<DSKLLBindData>, AggregateDestructorType::LEGACY>(
+        auto fun = AggregateFunction::UnaryAggregateDestructor<DSKLLState<T>, T, string_t, DSQuantilesCreateOperation<DSKLLBindData>, AggregateDestructorType::LEGACY>(
             type, result_type);
+        fun.simple_update = DSQuantilesSimpleUpdate<DSKLLState<T>, T, DSKLLBindData>;
+        return fun;
         
     }
 
+    
+    template <typename T>
+    auto static DSKLLCreateWeightedAggregate(const LogicalType &type, const LogicalType &result_type) -> AggregateFunction
+    {
+        auto fun = AggregateFunction::BinaryAggregate<DSKLLState<T>, T, int64_t, string_t, DSQuantilesWeightedCreateOperation<DSKLLBindData>, AggregateDestructorType::LEGACY>(
+            type, LogicalType::BIGINT, result_type);
+        fun.destructor = AggregateFunction::StateDestroy<DSKLLState<T>, DSQuantilesWeightedCreateOperation<DSKLLBindData>>;
+        return fun;
+    }
+
+    
+    
+
 
   void LoadKLLSketch(ExtensionLoader &loader) {
 
+      
+
 
       
         std::unordered_map<LogicalTypeId, LogicalType> sketch_map_types;
@@ -3513,6 +5609,14 @@ return sketch.get_max_item();
                 sketch.AddFunction(fun);
             }
             //sketch.AddFunction(DSKLLCreateAggregate<int8_t>(LogicalType::TINYINT, sketch_map_types[LogicalTypeId::TINYINT]));
+            
+            {
+                auto fun = DSKLLCreateWeightedAggregate<int8_t>(LogicalType::TINYINT, sketch_map_types[LogicalTypeId::TINYINT]);
+                fun.bind = DSKLLBind;
+                fun.arguments.insert(fun.arguments.begin(), LogicalType::INTEGER);
+                sketch.AddFunction(fun);
+            }
+            
             {
                 auto fun = DSKLLMergeAggregate<int8_t>(LogicalType::TINYINT, sketch_map_types[LogicalTypeId::TINYINT]);
                 fun.bind = DSKLLBind;
@@ -3529,6 +5633,14 @@ return sketch.get_max_item();
                 sketch.AddFunction(fun);
             }
             //sketch.AddFunction(DSKLLCreateAggregate<int16_t>(LogicalType::SMALLINT, sketch_map_types[LogicalTypeId::SMALLINT]));
+            
+            {
+                auto fun = DSKLLCreateWeightedAggregate<int16_t>(LogicalType::SMALLINT, sketch_map_types[LogicalTypeId::SMALLINT]);
+                fun.bind = DSKLLBind;
+                fun.arguments.insert(fun.arguments.begin(), LogicalType::INTEGER);
+                sketch.AddFunction(fun);
+            }
+            
             {
                 auto fun = DSKLLMergeAggregate<int16_t>(LogicalType::SMALLINT, sketch_map_types[LogicalTypeId::SMALLINT]);
                 fun.bind = DSKLLBind;
@@ -3545,6 +5657,14 @@ return sketch.get_max_item();
                 sketch.AddFunction(fun);
             }
             //sketch.AddFunction(DSKLLCreateAggregate<int32_t>(LogicalType::INTEGER, sketch_map_types[LogicalTypeId::INTEGER]));
+            
+            {
+                auto fun = DSKLLCreateWeightedAggregate<int32_t>(LogicalType::INTEGER, sketch_map_types[LogicalTypeId::INTEGER]);
+                fun.bind = DSKLLBind;
+                fun.arguments.insert(fun.arguments.begin(), LogicalType::INTEGER);
+                sketch.AddFunction(fun);
+            }
+            
             {
                 auto fun = DSKLLMergeAggregate<int32_t>(LogicalType::INTEGER, sketch_map_types[LogicalTypeId::INTEGER]);
                 fun.bind = DSKLLBind;
@@ -3561,6 +5681,14 @@ return sketch.get_max_item();
                 sketch.AddFunction(fun);
             }
             //sketch.AddFunction(DSKLLCreateAggregate<int64_t>(LogicalType::BIGINT, sketch_map_types[LogicalTypeId::BIGINT]));
+            
+            {
+                auto fun = DSKLLCreateWeightedAggregate<int64_t>(LogicalType::BIGINT, sketch_map_types[LogicalTypeId::BIGINT]);
+                fun.bind = DSKLLBind;
+                fun.arguments.insert(fun.arguments.begin(), LogicalType::INTEGER);
+                sketch.AddFunction(fun);
+            }
+            
             {
                 auto fun = DSKLLMergeAggregate<int64_t>(LogicalType::BIGINT, sketch_map_types[LogicalTypeId::BIGINT]);
                 fun.bind = DSKLLBind;
@@ -3577,6 +5705,14 @@ return sketch.get_max_item();
                 sketch.AddFunction(fun);
             }
             //sketch.AddFunction(DSKLLCreateAggregate<float>(LogicalType::FLOAT, sketch_map_types[LogicalTypeId::FLOAT]));
+            
+            {
+                auto fun = DSKLLCreateWeightedAggregate<float>(LogicalType::FLOAT, sketch_map_types[LogicalTypeId::FLOAT]);
+                fun.bind = DSKLLBind;
+                fun.arguments.insert(fun.arguments.begin(), LogicalType::INTEGER);
+                sketch.AddFunction(fun);
+            }
+            
             {
                 auto fun = DSKLLMergeAggregate<float>(LogicalType::FLOAT, sketch_map_types[LogicalTypeId::FLOAT]);
                 fun.bind = DSKLLBind;
@@ -3593,6 +5729,14 @@ return sketch.get_max_item();
                 sketch.AddFunction(fun);
             }
             //sketch.AddFunction(DSKLLCreateAggregate<double>(LogicalType::DOUBLE, sketch_map_types[LogicalTypeId::DOUBLE]));
+            
+            {
+                auto fun = DSKLLCreateWeightedAggregate<double>(LogicalType::DOUBLE, sketch_map_types[LogicalTypeId::DOUBLE]);
+                fun.bind = DSKLLBind;
+                fun.arguments.insert(fun.arguments.begin(), LogicalType::INTEGER);
+                sketch.AddFunction(fun);
+            }
+            
             {
                 auto fun = DSKLLMergeAggregate<double>(LogicalType::DOUBLE, sketch_map_types[LogicalTypeId::DOUBLE]);
                 fun.bind = DSKLLBind;
@@ -3609,6 +5753,14 @@ return sketch.get_max_item();
                 sketch.AddFunction(fun);
             }
             //sketch.AddFunction(DSKLLCreateAggregate<uint8_t>(LogicalType::UTINYINT, sketch_map_types[LogicalTypeId::UTINYINT]));
+            
+            {
+                auto fun = DSKLLCreateWeightedAggregate<uint8_t>(LogicalType::UTINYINT, sketch_map_types[LogicalTypeId::UTINYINT]);
+                fun.bind = DSKLLBind;
+                fun.arguments.insert(fun.arguments.begin(), LogicalType::INTEGER);
+                sketch.AddFunction(fun);
+            }
+            
             {
                 auto fun = DSKLLMergeAggregate<uint8_t>(LogicalType::UTINYINT, sketch_map_types[LogicalTypeId::UTINYINT]);
                 fun.bind = DSKLLBind;
@@ -3625,6 +5777,14 @@ return sketch.get_max_item();
                 sketch.AddFunction(fun);
             }
             //sketch.AddFunction(DSKLLCreateAggregate<uint16_t>(LogicalType::USMALLINT, sketch_map_types[LogicalTypeId::USMALLINT]));
+            
+            {
+                auto fun = DSKLLCreateWeightedAggregate<uint16_t>(LogicalType::USMALLINT, sketch_map_types[LogicalTypeId::USMALLINT]);
+                fun.bind = DSKLLBind;
+                fun.arguments.insert(fun.arguments.begin(), LogicalType::INTEGER);
+                sketch.AddFunction(fun);
+            }
+            
             {
                 auto fun = DSKLLMergeAggregate<uint16_t>(LogicalType::USMALLINT, sketch_map_types[LogicalTypeId::USMALLINT]);
                 fun.bind = DSKLLBind;
@@ -3641,6 +5801,14 @@ return sketch.get_max_item();
                 sketch.AddFunction(fun);
             }
             //sketch.AddFunction(DSKLLCreateAggregate<uint32_t>(LogicalType::UINTEGER, sketch_map_types[LogicalTypeId::UINTEGER]));
+            
+            {
+                auto fun = DSKLLCreateWeightedAggregate<uint32_t>(LogicalType::UINTEGER, sketch_map_types[LogicalTypeId::UINTEGER]);
+                fun.bind = DSKLLBind;
+                fun.arguments.insert(fun.arguments.begin(), LogicalType::INTEGER);
+                sketch.AddFunction(fun);
+            }
+            
             {
                 auto fun = DSKLLMergeAggregate<uint32_t>(LogicalType::UINTEGER, sketch_map_types[LogicalTypeId::UINTEGER]);
                 fun.bind = DSKLLBind;
@@ -3657,6 +5825,14 @@ return sketch.get_max_item();
                 sketch.AddFunction(fun);
             }
             //sketch.AddFunction(DSKLLCreateAggregate<uint64_t>(LogicalType::UBIGINT, sketch_map_types[LogicalTypeId::UBIGINT]));
+            
+            {
+                auto fun = DSKLLCreateWeightedAggregate<uint64_t>(LogicalType::UBIGINT, sketch_map_types[LogicalTypeId::UBIGINT]);
+                fun.bind = DSKLLBind;
+                fun.arguments.insert(fun.arguments.begin(), LogicalType::INTEGER);
+                sketch.AddFunction(fun);
+            }
+            
             {
                 auto fun = DSKLLMergeAggregate<uint64_t>(LogicalType::UBIGINT, sketch_map_types[LogicalTypeId::UBIGINT]);
                 fun.bind = DSKLLBind;
@@ -3665,6 +5841,7 @@ return sketch.get_max_item();
             }
             //sketch.AddFunction(DSKLLMergeAggregate<uint64_t>(LogicalType::UBIGINT, sketch_map_types[LogicalTypeId::UBIGINT]));
         
+      
       CreateAggregateFunctionInfo sketch_info(sketch);
 
 
@@ -3699,13 +5876,33 @@ static inline void DSREQis_empty(DataChunk &args, ExpressionState &state, Vector
 
     
         
+                    const bool sketch_is_constant = sketch_vector.GetVectorType() == VectorType::CONSTANT_VECTOR;
+                    std::optional<datasketches::req_sketch<T>> constant_sketch;
+                    
         UnaryExecutor::Execute
         <string_t,bool>
         (
         sketch_vector,result,args.size(),
-        [&](string_t sketch_data) {
+        [&](string_t sketch_data) -> bool {
+
+            
+                    {
+                        DSREQHeader header;
+                        if (DSREQReadHeader<T>(sketch_data.GetDataUnsafe(), sketch_data.GetSize(), header))
+                        {
+                            return header.empty;
+                        }
+                    }
+                    
 
-            auto sketch = datasketches::req_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize());
+                    std::optional<datasketches::req_sketch<T>> row_sketch;
+                    auto &sketch_holder = sketch_is_constant ? constant_sketch : row_sketch;
+                    if (!sketch_holder)
+                    {
+                        sketch_holder.emplace(datasketches::req_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize()));
+                    }
+                    auto &sketch = *sketch_holder;
+                    
 return sketch.is_empty();
         });
 
@@ -3726,13 +5923,33 @@ static inline void DSREQk(DataChunk &args, ExpressionState &state, Vector &resul
 
     
         
+                    const bool sketch_is_constant = sketch_vector.GetVectorType() == VectorType::CONSTANT_VECTOR;
+                    std::optional<datasketches::req_sketch<T>> constant_sketch;
+                    
         UnaryExecutor::Execute
         <string_t,uint16_t>
         (
         sketch_vector,result,args.size(),
-        [&](string_t sketch_data) {
+        [&](string_t sketch_data) -> uint16_t {
+
+            
+                    {
+                        DSREQHeader header;
+                        if (DSREQReadHeader<T>(sketch_data.GetDataUnsafe(), sketch_data.GetSize(), header))
+                        {
+                            return header.k;
+                        }
+                    }
+                    
 
-            auto sketch = datasketches::req_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize());
+                    std::optional<datasketches::req_sketch<T>> row_sketch;
+                    auto &sketch_holder = sketch_is_constant ? constant_sketch : row_sketch;
+                    if (!sketch_holder)
+                    {
+                        sketch_holder.emplace(datasketches::req_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize()));
+                    }
+                    auto &sketch = *sketch_holder;
+                    
 return sketch.get_k();
         });
 
@@ -3755,6 +5972,10 @@ static inline void DSREQcdf(DataChunk &args, ExpressionState &state, Vector &res
 
     
         
+                    const bool sketch_is_constant = sketch_vector.GetVectorType() == VectorType::CONSTANT_VECTOR;
+                    std::optional<datasketches::req_sketch<T>> constant_sketch;
+                    
+
                     UnifiedVectorFormat unified_split_points;
                     split_points_vector.ToUnifiedFormat(args.size(), unified_split_points);
 
@@ -3774,7 +5995,15 @@ static inline void DSREQcdf(DataChunk &args, ExpressionState &state, Vector &res
         sketch_vector,split_points_vector,inclusive_vector,result,args.size(),
         [&](string_t sketch_data,list_entry_t split_points_data,bool inclusive_data) {
 
-            auto sketch = datasketches::req_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize());
+            
+                    std::optional<datasketches::req_sketch<T>> row_sketch;
+                    auto &sketch_holder = sketch_is_constant ? constant_sketch : row_sketch;
+                    if (!sketch_holder)
+                    {
+                        sketch_holder.emplace(datasketches::req_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize()));
+                    }
+                    auto &sketch = *sketch_holder;
+                    
 
                     T *passing_points = (T *)malloc(sizeof(T) * split_points_data.length);
                     for (idx_t i = 0; i < split_points_data.length; i++)
@@ -3822,6 +6051,10 @@ static inline void DSREQpmf(DataChunk &args, ExpressionState &state, Vector &res
 
     
         
+                    const bool sketch_is_constant = sketch_vector.GetVectorType() == VectorType::CONSTANT_VECTOR;
+                    std::optional<datasketches::req_sketch<T>> constant_sketch;
+                    
+
                     UnifiedVectorFormat unified_split_points;
                     split_points_vector.ToUnifiedFormat(args.size(), unified_split_points);
 
@@ -3841,7 +6074,15 @@ static inline void DSREQpmf(DataChunk &args, ExpressionState &state, Vector &res
         sketch_vector,split_points_vector,inclusive_vector,result,args.size(),
         [&](string_t sketch_data,list_entry_t split_points_data,bool inclusive_data) {
 
-            auto sketch = datasketches::req_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize());
+            
+                    std::optional<datasketches::req_sketch<T>> row_sketch;
+                    auto &sketch_holder = sketch_is_constant ? constant_sketch : row_sketch;
+                    if (!sketch_holder)
+                    {
+                        sketch_holder.emplace(datasketches::req_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize()));
+                    }
+                    auto &sketch = *sketch_holder;
+                    
 
                     T *passing_points = (T *)malloc(sizeof(T) * split_points_data.length);
                     for (idx_t i = 0; i < split_points_data.length; i++)
@@ -3890,13 +6131,24 @@ static inline void DSREQdescribe(DataChunk &args, ExpressionState &state, Vector
 
     
         
+                    const bool sketch_is_constant = sketch_vector.GetVectorType() == VectorType::CONSTANT_VECTOR;
+                    std::optional<datasketches::req_sketch<T>> constant_sketch;
+                    
         TernaryExecutor::Execute
         <string_t,bool,bool,string_t>
         (
         sketch_vector,include_levels_vector,include_items_vector,result,args.size(),
         [&](string_t sketch_data,bool include_levels_data,bool include_items_data) {
 
-            auto sketch = datasketches::req_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize());
+            
+                    std::optional<datasketches::req_sketch<T>> row_sketch;
+                    auto &sketch_holder = sketch_is_constant ? constant_sketch : row_sketch;
+                    if (!sketch_holder)
+                    {
+                        sketch_holder.emplace(datasketches::req_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize()));
+                    }
+                    auto &sketch = *sketch_holder;
+                    
 return StringVector::AddString(result, sketch.to_string(include_levels_data, include_items_data));
         });
 
@@ -3919,13 +6171,24 @@ static inline void DSREQrank(DataChunk &args, ExpressionState &state, Vector &re
 
     
         
+                    const bool sketch_is_constant = sketch_vector.GetVectorType() == VectorType::CONSTANT_VECTOR;
+                    std::optional<datasketches::req_sketch<T>> constant_sketch;
+                    
         TernaryExecutor::Execute
         <string_t,T,bool,double>
         (
         sketch_vector,item_vector,inclusive_vector,result,args.size(),
         [&](string_t sketch_data,T item_data,bool inclusive_data) {
 
-            auto sketch = datasketches::req_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize());
+            
+                    std::optional<datasketches::req_sketch<T>> row_sketch;
+                    auto &sketch_holder = sketch_is_constant ? constant_sketch : row_sketch;
+                    if (!sketch_holder)
+                    {
+                        sketch_holder.emplace(datasketches::req_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize()));
+                    }
+                    auto &sketch = *sketch_holder;
+                    
 return sketch.get_rank(item_data, inclusive_data);
         });
 
@@ -3948,13 +6211,24 @@ static inline void DSREQquantile(DataChunk &args, ExpressionState &state, Vector
 
     
         
+                    const bool sketch_is_constant = sketch_vector.GetVectorType() == VectorType::CONSTANT_VECTOR;
+                    std::optional<datasketches::req_sketch<T>> constant_sketch;
+                    
         TernaryExecutor::Execute
         <string_t,double,bool,T>
         (
         sketch_vector,rank_vector,inclusive_vector,result,args.size(),
         [&](string_t sketch_data,double rank_data,bool inclusive_data) {
 
-            auto sketch = datasketches::req_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize());
+            
+                    std::optional<datasketches::req_sketch<T>> row_sketch;
+                    auto &sketch_holder = sketch_is_constant ? constant_sketch : row_sketch;
+                    if (!sketch_holder)
+                    {
+                        sketch_holder.emplace(datasketches::req_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize()));
+                    }
+                    auto &sketch = *sketch_holder;
+                    
 return sketch.get_quantile(rank_data, inclusive_data);
         });
 
@@ -3975,13 +6249,33 @@ static inline void DSREQn(DataChunk &args, ExpressionState &state, Vector &resul
 
     
         
+                    const bool sketch_is_constant = sketch_vector.GetVectorType() == VectorType::CONSTANT_VECTOR;
+                    std::optional<datasketches::req_sketch<T>> constant_sketch;
+                    
         UnaryExecutor::Execute
         <string_t,uint64_t>
         (
         sketch_vector,result,args.size(),
-        [&](string_t sketch_data) {
+        [&](string_t sketch_data) -> uint64_t {
+
+            
+                    {
+                        DSREQHeader header;
+                        if (DSREQReadHeader<T>(sketch_data.GetDataUnsafe(), sketch_data.GetSize(), header) && header.has_n)
+                        {
+                            return header.n;
+                        }
+                    }
+                    
 
-            auto sketch = datasketches::req_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize());
+                    std::optional<datasketches::req_sketch<T>> row_sketch;
+                    auto &sketch_holder = sketch_is_constant ? constant_sketch : row_sketch;
+                    if (!sketch_holder)
+                    {
+                        sketch_holder.emplace(datasketches::req_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize()));
+                    }
+                    auto &sketch = *sketch_holder;
+                    
 return sketch.get_n();
         });
 
@@ -4002,13 +6296,33 @@ static inline void DSREQis_estimation_mode(DataChunk &args, ExpressionState &sta
 
     
         
+                    const bool sketch_is_constant = sketch_vector.GetVectorType() == VectorType::CONSTANT_VECTOR;
+                    std::optional<datasketches::req_sketch<T>> constant_sketch;
+                    
         UnaryExecutor::Execute
         <string_t,bool>
         (
         sketch_vector,result,args.size(),
-        [&](string_t sketch_data) {
+        [&](string_t sketch_data) -> bool {
+
+            
+                    {
+                        DSREQHeader header;
+                        if (DSREQReadHeader<T>(sketch_data.GetDataUnsafe(), sketch_data.GetSize(), header))
+                        {
+                            return header.estimation_mode;
+                        }
+                    }
+                    
 
-            auto sketch = datasketches::req_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize());
+                    std::optional<datasketches::req_sketch<T>> row_sketch;
+                    auto &sketch_holder = sketch_is_constant ? constant_sketch : row_sketch;
+                    if (!sketch_holder)
+                    {
+                        sketch_holder.emplace(datasketches::req_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize()));
+                    }
+                    auto &sketch = *sketch_holder;
+                    
 return sketch.is_estimation_mode();
         });
 
@@ -4029,13 +6343,33 @@ static inline void DSREQnum_retained(DataChunk &args, ExpressionState &state, Ve
 
     
         
+                    const bool sketch_is_constant = sketch_vector.GetVectorType() == VectorType::CONSTANT_VECTOR;
+                    std::optional<datasketches::req_sketch<T>> constant_sketch;
+                    
         UnaryExecutor::Execute
         <string_t,uint64_t>
         (
         sketch_vector,result,args.size(),
-        [&](string_t sketch_data) {
+        [&](string_t sketch_data) -> uint64_t {
+
+            
+                    {
+                        DSREQHeader header;
+                        if (DSREQReadHeader<T>(sketch_data.GetDataUnsafe(), sketch_data.GetSize(), header) && header.has_num_retained)
+                        {
+                            return header.num_retained;
+                        }
+                    }
+                    
 
-            auto sketch = datasketches::req_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize());
+                    std::optional<datasketches::req_sketch<T>> row_sketch;
+                    auto &sketch_holder = sketch_is_constant ? constant_sketch : row_sketch;
+                    if (!sketch_holder)
+                    {
+                        sketch_holder.emplace(datasketches::req_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize()));
+                    }
+                    auto &sketch = *sketch_holder;
+                    
 return sketch.get_num_retained();
         });
 
@@ -4056,13 +6390,24 @@ static inline void DSREQmin_item(DataChunk &args, ExpressionState &state, Vector
 
     
         
+                    const bool sketch_is_constant = sketch_vector.GetVectorType() == VectorType::CONSTANT_VECTOR;
+                    std::optional<datasketches::req_sketch<T>> constant_sketch;
+                    
         UnaryExecutor::Execute
         <string_t,T>
         (
         sketch_vector,result,args.size(),
         [&](string_t sketch_data) {
 
-            auto sketch = datasketches::req_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize());
+            
+                    std::optional<datasketches::req_sketch<T>> row_sketch;
+                    auto &sketch_holder = sketch_is_constant ? constant_sketch : row_sketch;
+                    if (!sketch_holder)
+                    {
+                        sketch_holder.emplace(datasketches::req_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize()));
+                    }
+                    auto &sketch = *sketch_holder;
+                    
 return sketch.get_min_item();
         });
 
@@ -4083,13 +6428,24 @@ static inline void DSREQmax_item(DataChunk &args, ExpressionState &state, Vector
 
     
         
+                    const bool sketch_is_constant = sketch_vector.GetVectorType() == VectorType::CONSTANT_VECTOR;
+                    std::optional<datasketches::req_sketch<T>> constant_sketch;
+                    
         UnaryExecutor::Execute
         <string_t,T>
         (
         sketch_vector,result,args.size(),
         [&](string_t sketch_data) {
 
-            auto sketch = datasketches::req_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize());
+            
+                    std::optional<datasketches::req_sketch<T>> row_sketch;
+                    auto &sketch_holder = sketch_is_constant ? constant_sketch : row_sketch;
+                    if (!sketch_holder)
+                    {
+                        sketch_holder.emplace(datasketches::req_sketch<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize()));
+                    }
+                    auto &sketch = *sketch_holder;
+                    
 return sketch.get_max_item();
         });
 
@@ -4115,14 +6471,21 @@ return sketch.get_max_item();
     auto static DSREQCreateAggregate(const LogicalType &type, const LogicalType &result_type) -> AggregateFunction
     {
         
-        return AggregateFunction::UnaryAggregateDestructor<DSREQState<T>, T, string_t, DSQuantilesCreateOperation<DSREQBindData>, AggregateDestructorType::LEGACY>(
+        auto fun = AggregateFunction::UnaryAggregateDestructor<DSREQState<T>, T, string_t, DSQuantilesCreateOperation<DSREQBindData>, AggregateDestructorType::LEGACY>(
             type, result_type);
+        fun.simple_update = DSQuantilesSimpleUpdate<DSREQState<T>, T, DSREQBindData>;
+        return fun;
         
     }
 
+    
+    
+
 
   void LoadREQSketch(ExtensionLoader &loader) {
 
+      
+
 
       
         std::unordered_map<LogicalTypeId, LogicalType> sketch_map_types;
@@ -4741,6 +7104,7 @@ return sketch.get_max_item();
                 sketch.AddFunction(fun);
             }
             //sketch.AddFunction(DSREQCreateAggregate<int8_t>(LogicalType::TINYINT, sketch_map_types[LogicalTypeId::TINYINT]));
+            
             {
                 auto fun = DSREQMergeAggregate<int8_t>(LogicalType::TINYINT, sketch_map_types[LogicalTypeId::TINYINT]);
                 fun.bind = DSREQBind;
@@ -4757,6 +7121,7 @@ return sketch.get_max_item();
                 sketch.AddFunction(fun);
             }
             //sketch.AddFunction(DSREQCreateAggregate<int16_t>(LogicalType::SMALLINT, sketch_map_types[LogicalTypeId::SMALLINT]));
+            
             {
                 auto fun = DSREQMergeAggregate<int16_t>(LogicalType::SMALLINT, sketch_map_types[LogicalTypeId::SMALLINT]);
                 fun.bind = DSREQBind;
@@ -4773,6 +7138,7 @@ return sketch.get_max_item();
                 sketch.AddFunction(fun);
             }
             //sketch.AddFunction(DSREQCreateAggregate<int32_t>(LogicalType::INTEGER, sketch_map_types[LogicalTypeId::INTEGER]));
+            
             {
                 auto fun = DSREQMergeAggregate<int32_t>(LogicalType::INTEGER, sketch_map_types[LogicalTypeId::INTEGER]);
                 fun.bind = DSREQBind;
@@ -4789,6 +7155,7 @@ return sketch.get_max_item();
                 sketch.AddFunction(fun);
             }
             //sketch.AddFunction(DSREQCreateAggregate<int64_t>(LogicalType::BIGINT, sketch_map_types[LogicalTypeId::BIGINT]));
+            
             {
                 auto fun = DSREQMergeAggregate<int64_t>(LogicalType::BIGINT, sketch_map_types[LogicalTypeId::BIGINT]);
                 fun.bind = DSREQBind;
@@ -4805,6 +7172,7 @@ return sketch.get_max_item();
                 sketch.AddFunction(fun);
             }
             //sketch.AddFunction(DSREQCreateAggregate<float>(LogicalType::FLOAT, sketch_map_types[LogicalTypeId::FLOAT]));
+            
             {
                 auto fun = DSREQMergeAggregate<float>(LogicalType::FLOAT, sketch_map_types[LogicalTypeId::FLOAT]);
                 fun.bind = DSREQBind;
@@ -4821,6 +7189,7 @@ return sketch.get_max_item();
                 sketch.AddFunction(fun);
             }
             //sketch.AddFunction(DSREQCreateAggregate<double>(LogicalType::DOUBLE, sketch_map_types[LogicalTypeId::DOUBLE]));
+            
             {
                 auto fun = DSREQMergeAggregate<double>(LogicalType::DOUBLE, sketch_map_types[LogicalTypeId::DOUBLE]);
                 fun.bind = DSREQBind;
@@ -4837,6 +7206,7 @@ return sketch.get_max_item();
                 sketch.AddFunction(fun);
             }
             //sketch.AddFunction(DSREQCreateAggregate<uint8_t>(LogicalType::UTINYINT, sketch_map_types[LogicalTypeId::UTINYINT]));
+            
             {
                 auto fun = DSREQMergeAggregate<uint8_t>(LogicalType::UTINYINT, sketch_map_types[LogicalTypeId::UTINYINT]);
                 fun.bind = DSREQBind;
@@ -4853,6 +7223,7 @@ return sketch.get_max_item();
                 sketch.AddFunction(fun);
             }
             //sketch.AddFunction(DSREQCreateAggregate<uint16_t>(LogicalType::USMALLINT, sketch_map_types[LogicalTypeId::USMALLINT]));
+            
             {
                 auto fun = DSREQMergeAggregate<uint16_t>(LogicalType::USMALLINT, sketch_map_types[LogicalTypeId::USMALLINT]);
                 fun.bind = DSREQBind;
@@ -4869,6 +7240,7 @@ return sketch.get_max_item();
                 sketch.AddFunction(fun);
             }
             //sketch.AddFunction(DSREQCreateAggregate<uint32_t>(LogicalType::UINTEGER, sketch_map_types[LogicalTypeId::UINTEGER]));
+            
             {
                 auto fun = DSREQMergeAggregate<uint32_t>(LogicalType::UINTEGER, sketch_map_types[LogicalTypeId::UINTEGER]);
                 fun.bind = DSREQBind;
@@ -4885,6 +7257,7 @@ return sketch.get_max_item();
                 sketch.AddFunction(fun);
             }
             //sketch.AddFunction(DSREQCreateAggregate<uint64_t>(LogicalType::UBIGINT, sketch_map_types[LogicalTypeId::UBIGINT]));
+            
             {
                 auto fun = DSREQMergeAggregate<uint64_t>(LogicalType::UBIGINT, sketch_map_types[LogicalTypeId::UBIGINT]);
                 fun.bind = DSREQBind;
@@ -4893,6 +7266,7 @@ return sketch.get_max_item();
             }
             //sketch.AddFunction(DSREQMergeAggregate<uint64_t>(LogicalType::UBIGINT, sketch_map_types[LogicalTypeId::UBIGINT]));
         
+      
       CreateAggregateFunctionInfo sketch_info(sketch);
 
 
@@ -4927,13 +7301,33 @@ static inline void DSTDigestis_empty(DataChunk &args, ExpressionState &state, Ve
 
     
         
+                    const bool sketch_is_constant = sketch_vector.GetVectorType() == VectorType::CONSTANT_VECTOR;
+                    std::optional<datasketches::tdigest<T>> constant_sketch;
+                    
         UnaryExecutor::Execute
         <string_t,bool>
         (
         sketch_vector,result,args.size(),
-        [&](string_t sketch_data) {
+        [&](string_t sketch_data) -> bool {
+
+            
+                    {
+                        DSTDigestHeader header;
+                        if (DSTDigestReadHeader(sketch_data.GetDataUnsafe(), sketch_data.GetSize(), header))
+                        {
+                            return header.empty;
+                        }
+                    }
+                    
 
-            auto sketch = datasketches::tdigest<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize());
+                    std::optional<datasketches::tdigest<T>> row_sketch;
+                    auto &sketch_holder = sketch_is_constant ? constant_sketch : row_sketch;
+                    if (!sketch_holder)
+                    {
+                        sketch_holder.emplace(datasketches::tdigest<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize()));
+                    }
+                    auto &sketch = *sketch_holder;
+                    
 return sketch.is_empty();
         });
 
@@ -4954,13 +7348,33 @@ static inline void DSTDigestk(DataChunk &args, ExpressionState &state, Vector &r
 
     
         
+                    const bool sketch_is_constant = sketch_vector.GetVectorType() == VectorType::CONSTANT_VECTOR;
+                    std::optional<datasketches::tdigest<T>> constant_sketch;
+                    
         UnaryExecutor::Execute
         <string_t,uint16_t>
         (
         sketch_vector,result,args.size(),
-        [&](string_t sketch_data) {
+        [&](string_t sketch_data) -> uint16_t {
+
+            
+                    {
+                        DSTDigestHeader header;
+                        if (DSTDigestReadHeader(sketch_data.GetDataUnsafe(), sketch_data.GetSize(), header))
+                        {
+                            return header.k;
+                        }
+                    }
+                    
 
-            auto sketch = datasketches::tdigest<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize());
+                    std::optional<datasketches::tdigest<T>> row_sketch;
+                    auto &sketch_holder = sketch_is_constant ? constant_sketch : row_sketch;
+                    if (!sketch_holder)
+                    {
+                        sketch_holder.emplace(datasketches::tdigest<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize()));
+                    }
+                    auto &sketch = *sketch_holder;
+                    
 return sketch.get_k();
         });
 
@@ -4982,6 +7396,10 @@ static inline void DSTDigestcdf(DataChunk &args, ExpressionState &state, Vector
 
     
         
+                    const bool sketch_is_constant = sketch_vector.GetVectorType() == VectorType::CONSTANT_VECTOR;
+                    std::optional<datasketches::tdigest<T>> constant_sketch;
+                    
+
                     UnifiedVectorFormat unified_split_points;
                     split_points_vector.ToUnifiedFormat(args.size(), unified_split_points);
 
@@ -5001,7 +7419,15 @@ static inline void DSTDigestcdf(DataChunk &args, ExpressionState &state, Vector
         sketch_vector,split_points_vector,result,args.size(),
         [&](string_t sketch_data,list_entry_t split_points_data) {
 
-            auto sketch = datasketches::tdigest<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize());
+            
+                    std::optional<datasketches::tdigest<T>> row_sketch;
+                    auto &sketch_holder = sketch_is_constant ? constant_sketch : row_sketch;
+                    if (!sketch_holder)
+                    {
+                        sketch_holder.emplace(datasketches::tdigest<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize()));
+                    }
+                    auto &sketch = *sketch_holder;
+                    
 
                     T *passing_points = (T *)malloc(sizeof(T) * split_points_data.length);
                     for (idx_t i = 0; i < split_points_data.length; i++)
@@ -5048,6 +7474,10 @@ static inline void DSTDigestpmf(DataChunk &args, ExpressionState &state, Vector
 
     
         
+                    const bool sketch_is_constant = sketch_vector.GetVectorType() == VectorType::CONSTANT_VECTOR;
+                    std::optional<datasketches::tdigest<T>> constant_sketch;
+                    
+
                     UnifiedVectorFormat unified_split_points;
                     split_points_vector.ToUnifiedFormat(args.size(), unified_split_points);
 
@@ -5067,7 +7497,15 @@ static inline void DSTDigestpmf(DataChunk &args, ExpressionState &state, Vector
         sketch_vector,split_points_vector,result,args.size(),
         [&](string_t sketch_data,list_entry_t split_points_data) {
 
-            auto sketch = datasketches::tdigest<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize());
+            
+                    std::optional<datasketches::tdigest<T>> row_sketch;
+                    auto &sketch_holder = sketch_is_constant ? constant_sketch : row_sketch;
+                    if (!sketch_holder)
+                    {
+                        sketch_holder.emplace(datasketches::tdigest<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize()));
+                    }
+                    auto &sketch = *sketch_holder;
+                    
 
                     T *passing_points = (T *)malloc(sizeof(T) * split_points_data.length);
                     for (idx_t i = 0; i < split_points_data.length; i++)
@@ -5115,13 +7553,24 @@ static inline void DSTDigestdescribe(DataChunk &args, ExpressionState &state, Ve
 
     
         
+                    const bool sketch_is_constant = sketch_vector.GetVectorType() == VectorType::CONSTANT_VECTOR;
+                    std::optional<datasketches::tdigest<T>> constant_sketch;
+                    
         BinaryExecutor::Execute
         <string_t,bool,string_t>
         (
         sketch_vector,include_centroids_vector,result,args.size(),
         [&](string_t sketch_data,bool include_centroids_data) {
 
-            auto sketch = datasketches::tdigest<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize());
+            
+                    std::optional<datasketches::tdigest<T>> row_sketch;
+                    auto &sketch_holder = sketch_is_constant ? constant_sketch : row_sketch;
+                    if (!sketch_holder)
+                    {
+                        sketch_holder.emplace(datasketches::tdigest<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize()));
+                    }
+                    auto &sketch = *sketch_holder;
+                    
 return StringVector::AddString(result, sketch.to_string(include_centroids_data));
         });
 
@@ -5143,13 +7592,24 @@ static inline void DSTDigestrank(DataChunk &args, ExpressionState &state, Vector
 
     
         
+                    const bool sketch_is_constant = sketch_vector.GetVectorType() == VectorType::CONSTANT_VECTOR;
+                    std::optional<datasketches::tdigest<T>> constant_sketch;
+                    
         BinaryExecutor::Execute
         <string_t,T,double>
         (
         sketch_vector,item_vector,result,args.size(),
         [&](string_t sketch_data,T item_data) {
 
-            auto sketch = datasketches::tdigest<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize());
+            
+                    std::optional<datasketches::tdigest<T>> row_sketch;
+                    auto &sketch_holder = sketch_is_constant ? constant_sketch : row_sketch;
+                    if (!sketch_holder)
+                    {
+                        sketch_holder.emplace(datasketches::tdigest<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize()));
+                    }
+                    auto &sketch = *sketch_holder;
+                    
 return sketch.get_rank(item_data);
         });
 
@@ -5170,13 +7630,33 @@ static inline void DSTDigesttotal_weight(DataChunk &args, ExpressionState &state
 
     
         
+                    const bool sketch_is_constant = sketch_vector.GetVectorType() == VectorType::CONSTANT_VECTOR;
+                    std::optional<datasketches::tdigest<T>> constant_sketch;
+                    
         UnaryExecutor::Execute
         <string_t,uint64_t>
         (
         sketch_vector,result,args.size(),
-        [&](string_t sketch_data) {
+        [&](string_t sketch_data) -> uint64_t {
+
+            
+                    {
+                        DSTDigestHeader header;
+                        if (DSTDigestReadHeader(sketch_data.GetDataUnsafe(), sketch_data.GetSize(), header) && header.has_total_weight)
+                        {
+                            return header.total_weight;
+                        }
+                    }
+                    
 
-            auto sketch = datasketches::tdigest<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize());
+                    std::optional<datasketches::tdigest<T>> row_sketch;
+                    auto &sketch_holder = sketch_is_constant ? constant_sketch : row_sketch;
+                    if (!sketch_holder)
+                    {
+                        sketch_holder.emplace(datasketches::tdigest<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize()));
+                    }
+                    auto &sketch = *sketch_holder;
+                    
 return sketch.get_total_weight();
         });
 
@@ -5198,13 +7678,24 @@ static inline void DSTDigestquantile(DataChunk &args, ExpressionState &state, Ve
 
     
         
+                    const bool sketch_is_constant = sketch_vector.GetVectorType() == VectorType::CONSTANT_VECTOR;
+                    std::optional<datasketches::tdigest<T>> constant_sketch;
+                    
         BinaryExecutor::Execute
         <string_t,double,T>
         (
         sketch_vector,rank_vector,result,args.size(),
         [&](string_t sketch_data,double rank_data) {
 
-            auto sketch = datasketches::tdigest<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize());
+            
+                    std::optional<datasketches::tdigest<T>> row_sketch;
+                    auto &sketch_holder = sketch_is_constant ? constant_sketch : row_sketch;
+                    if (!sketch_holder)
+                    {
+                        sketch_holder.emplace(datasketches::tdigest<T>::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize()));
+                    }
+                    auto &sketch = *sketch_holder;
+                    
 return sketch.get_quantile(rank_data);
         });
 
@@ -5230,14 +7721,31 @@ return sketch.get_quantile(rank_data);
     auto static DSTDigestCreateAggregate(const LogicalType &type, const LogicalType &result_type) -> AggregateFunction
     {
         
-        return AggregateFunction::UnaryAggregateDestructor<DSTDigestState<T>, T, string_t, DSQuantilesCreateOperation<DSTDigestBindData>, AggregateDestructorType::LEGACY>(
+        auto fun = AggregateFunction::UnaryAggregateDestructor<DSTDigestState<T>, T, string_t, DSQuantilesCreateOperation<DSTDigestBindData>, AggregateDestructorType::LEGACY>(
             type, result_type);
+        fun.simple_update = DSQuantilesSimpleUpdate<DSTDigestState<T>, T, DSTDigestBindData>;
+        return fun;
         
     }
 
+    
+    template <typename T>
+    auto static DSTDigestCreateWeightedAggregate(const LogicalType &type, const LogicalType &result_type) -> AggregateFunction
+    {
+        auto fun = AggregateFunction::BinaryAggregate<DSTDigestState<T>, T, int64_t, string_t, DSQuantilesWeightedCreateOperation<DSTDigestBindData>, AggregateDestructorType::LEGACY>(
+            type, LogicalType::BIGINT, result_type);
+        fun.destructor = AggregateFunction::StateDestroy<DSTDigestState<T>, DSQuantilesWeightedCreateOperation<DSTDigestBindData>>;
+        return fun;
+    }
+
+    
+    
+
 
   void LoadTDigestSketch(ExtensionLoader &loader) {
 
+      
+
 
       
         std::unordered_map<LogicalTypeId, LogicalType> sketch_map_types;
@@ -5460,6 +7968,14 @@ return sketch.get_quantile(rank_data);
                 sketch.AddFunction(fun);
             }
             //sketch.AddFunction(DSTDigestCreateAggregate<float>(LogicalType::FLOAT, sketch_map_types[LogicalTypeId::FLOAT]));
+            
+            {
+                auto fun = DSTDigestCreateWeightedAggregate<float>(LogicalType::FLOAT, sketch_map_types[LogicalTypeId::FLOAT]);
+                fun.bind = DSTDigestBind;
+                fun.arguments.insert(fun.arguments.begin(), LogicalType::INTEGER);
+                sketch.AddFunction(fun);
+            }
+            
             {
                 auto fun = DSTDigestMergeAggregate<float>(LogicalType::FLOAT, sketch_map_types[LogicalTypeId::FLOAT]);
                 fun.bind = DSTDigestBind;
@@ -5476,6 +7992,14 @@ return sketch.get_quantile(rank_data);
                 sketch.AddFunction(fun);
             }
             //sketch.AddFunction(DSTDigestCreateAggregate<double>(LogicalType::DOUBLE, sketch_map_types[LogicalTypeId::DOUBLE]));
+            
+            {
+                auto fun = DSTDigestCreateWeightedAggregate<double>(LogicalType::DOUBLE, sketch_map_types[LogicalTypeId::DOUBLE]);
+                fun.bind = DSTDigestBind;
+                fun.arguments.insert(fun.arguments.begin(), LogicalType::INTEGER);
+                sketch.AddFunction(fun);
+            }
+            
             {
                 auto fun = DSTDigestMergeAggregate<double>(LogicalType::DOUBLE, sketch_map_types[LogicalTypeId::DOUBLE]);
                 fun.bind = DSTDigestBind;
@@ -5484,6 +8008,7 @@ return sketch.get_quantile(rank_data);
             }
             //sketch.AddFunction(DSTDigestMergeAggregate<double>(LogicalType::DOUBLE, sketch_map_types[LogicalTypeId::DOUBLE]));
         
+      
       CreateAggregateFunctionInfo sketch_info(sketch);
 
 
@@ -5516,13 +8041,33 @@ static inline void DSHLLis_empty(DataChunk &args, ExpressionState &state, Vector
 
     
         
+                    const bool sketch_is_constant = sketch_vector.GetVectorType() == VectorType::CONSTANT_VECTOR;
+                    std::optional<datasketches::hll_sketch> constant_sketch;
+                    
         UnaryExecutor::Execute
         <string_t,bool>
         (
         sketch_vector,result,args.size(),
-        [&](string_t sketch_data) {
+        [&](string_t sketch_data) -> bool {
+
+            
+                    {
+                        DSHLLHeader header;
+                        if (DSHLLReadHeader(sketch_data.GetDataUnsafe(), sketch_data.GetSize(), header))
+                        {
+                            return header.empty;
+                        }
+                    }
+                    
 
-            auto sketch = datasketches::hll_sketch::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize());
+                    std::optional<datasketches::hll_sketch> row_sketch;
+                    auto &sketch_holder = sketch_is_constant ? constant_sketch : row_sketch;
+                    if (!sketch_holder)
+                    {
+                        sketch_holder.emplace(datasketches::hll_sketch::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize()));
+                    }
+                    auto &sketch = *sketch_holder;
+                    
 return sketch.is_empty();
         });
 
@@ -5543,13 +8088,24 @@ static inline void DSHLLdescribe(DataChunk &args, ExpressionState &state, Vector
 
     
         
+                    const bool sketch_is_constant = sketch_vector.GetVectorType() == VectorType::CONSTANT_VECTOR;
+                    std::optional<datasketches::hll_sketch> constant_sketch;
+                    
         TernaryExecutor::Execute
         <string_t,bool,bool,string_t>
         (
         sketch_vector,summary_vector,detail_vector,result,args.size(),
         [&](string_t sketch_data,bool summary_data,bool detail_data) {
 
-            auto sketch = datasketches::hll_sketch::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize());
+            
+                    std::optional<datasketches::hll_sketch> row_sketch;
+                    auto &sketch_holder = sketch_is_constant ? constant_sketch : row_sketch;
+                    if (!sketch_holder)
+                    {
+                        sketch_holder.emplace(datasketches::hll_sketch::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize()));
+                    }
+                    auto &sketch = *sketch_holder;
+                    
 return StringVector::AddString(result, sketch.to_string(summary_data, detail_data, false, false));
         });
 
@@ -5568,13 +8124,33 @@ static inline void DSHLLlg_config_k(DataChunk &args, ExpressionState &state, Vec
 
     
         
+                    const bool sketch_is_constant = sketch_vector.GetVectorType() == VectorType::CONSTANT_VECTOR;
+                    std::optional<datasketches::hll_sketch> constant_sketch;
+                    
         UnaryExecutor::Execute
         <string_t,uint8_t>
         (
         sketch_vector,result,args.size(),
-        [&](string_t sketch_data) {
+        [&](string_t sketch_data) -> uint8_t {
+
+            
+                    {
+                        DSHLLHeader header;
+                        if (DSHLLReadHeader(sketch_data.GetDataUnsafe(), sketch_data.GetSize(), header))
+                        {
+                            return header.lg_config_k;
+                        }
+                    }
+                    
 
-            auto sketch = datasketches::hll_sketch::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize());
+                    std::optional<datasketches::hll_sketch> row_sketch;
+                    auto &sketch_holder = sketch_is_constant ? constant_sketch : row_sketch;
+                    if (!sketch_holder)
+                    {
+                        sketch_holder.emplace(datasketches::hll_sketch::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize()));
+                    }
+                    auto &sketch = *sketch_holder;
+                    
 return sketch.get_lg_config_k();
         });
 
@@ -5593,13 +8169,33 @@ static inline void DSHLLis_compact(DataChunk &args, ExpressionState &state, Vect
 
     
         
+                    const bool sketch_is_constant = sketch_vector.GetVectorType() == VectorType::CONSTANT_VECTOR;
+                    std::optional<datasketches::hll_sketch> constant_sketch;
+                    
         UnaryExecutor::Execute
         <string_t,bool>
         (
         sketch_vector,result,args.size(),
-        [&](string_t sketch_data) {
+        [&](string_t sketch_data) -> bool {
+
+            
+                    {
+                        DSHLLHeader header;
+                        if (DSHLLReadHeader(sketch_data.GetDataUnsafe(), sketch_data.GetSize(), header))
+                        {
+                            return header.compact;
+                        }
+                    }
+                    
 
-            auto sketch = datasketches::hll_sketch::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize());
+                    std::optional<datasketches::hll_sketch> row_sketch;
+                    auto &sketch_holder = sketch_is_constant ? constant_sketch : row_sketch;
+                    if (!sketch_holder)
+                    {
+                        sketch_holder.emplace(datasketches::hll_sketch::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize()));
+                    }
+                    auto &sketch = *sketch_holder;
+                    
 return sketch.is_compact();
         });
 
@@ -5618,13 +8214,33 @@ static inline void DSHLLestimate(DataChunk &args, ExpressionState &state, Vector
 
     
         
+                    const bool sketch_is_constant = sketch_vector.GetVectorType() == VectorType::CONSTANT_VECTOR;
+                    std::optional<datasketches::hll_sketch> constant_sketch;
+                    
         UnaryExecutor::Execute
         <string_t,double>
         (
         sketch_vector,result,args.size(),
-        [&](string_t sketch_data) {
+        [&](string_t sketch_data) -> double {
+
+            
+                    {
+                        DSHLLHeader header;
+                        if (DSHLLReadHeader(sketch_data.GetDataUnsafe(), sketch_data.GetSize(), header) && header.has_estimate)
+                        {
+                            return header.estimate;
+                        }
+                    }
+                    
 
-            auto sketch = datasketches::hll_sketch::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize());
+                    std::optional<datasketches::hll_sketch> row_sketch;
+                    auto &sketch_holder = sketch_is_constant ? constant_sketch : row_sketch;
+                    if (!sketch_holder)
+                    {
+                        sketch_holder.emplace(datasketches::hll_sketch::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize()));
+                    }
+                    auto &sketch = *sketch_holder;
+                    
 return sketch.get_estimate();
         });
 
@@ -5644,13 +8260,24 @@ static inline void DSHLLlower_bound(DataChunk &args, ExpressionState &state, Vec
 
     
         
+                    const bool sketch_is_constant = sketch_vector.GetVectorType() == VectorType::CONSTANT_VECTOR;
+                    std::optional<datasketches::hll_sketch> constant_sketch;
+                    
         BinaryExecutor::Execute
         <string_t,uint8_t,double>
         (
         sketch_vector,std_dev_vector,result,args.size(),
         [&](string_t sketch_data,uint8_t std_dev_data) {
 
-            auto sketch = datasketches::hll_sketch::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize());
+            
+                    std::optional<datasketches::hll_sketch> row_sketch;
+                    auto &sketch_holder = sketch_is_constant ? constant_sketch : row_sketch;
+                    if (!sketch_holder)
+                    {
+                        sketch_holder.emplace(datasketches::hll_sketch::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize()));
+                    }
+                    auto &sketch = *sketch_holder;
+                    
 return sketch.get_lower_bound(std_dev_data);
         });
 
@@ -5670,13 +8297,24 @@ static inline void DSHLLupper_bound(DataChunk &args, ExpressionState &state, Vec
 
     
         
+                    const bool sketch_is_constant = sketch_vector.GetVectorType() == VectorType::CONSTANT_VECTOR;
+                    std::optional<datasketches::hll_sketch> constant_sketch;
+                    
         BinaryExecutor::Execute
         <string_t,uint8_t,double>
         (
         sketch_vector,std_dev_vector,result,args.size(),
         [&](string_t sketch_data,uint8_t std_dev_data) {
 
-            auto sketch = datasketches::hll_sketch::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize());
+            
+                    std::optional<datasketches::hll_sketch> row_sketch;
+                    auto &sketch_holder = sketch_is_constant ? constant_sketch : row_sketch;
+                    if (!sketch_holder)
+                    {
+                        sketch_holder.emplace(datasketches::hll_sketch::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize()));
+                    }
+                    auto &sketch = *sketch_holder;
+                    
 return sketch.get_upper_bound(std_dev_data);
         });
 
@@ -5701,14 +8339,71 @@ return sketch.get_upper_bound(std_dev_data);
     auto static DSHLLCreateAggregate(const LogicalType &type, const LogicalType &result_type) -> AggregateFunction
     {
         
-        return AggregateFunction::UnaryAggregateDestructor<DSHLLState, T, string_t, DSHLLCreateOperation<DSHLLBindData>, AggregateDestructorType::LEGACY>(
+        auto fun = AggregateFunction::UnaryAggregateDestructor<DSHLLState, T, string_t, DSHLLCreateOperation<DSHLLBindData>, AggregateDestructorType::LEGACY>(
             type, result_type);
+        fun.simple_update = DSCountingSketchSimpleUpdate<DSHLLState, T, DSHLLBindData>;
+        return fun;
         
     }
 
+    
+    
+    template <typename T>
+    auto static DSHLLCreateEnumAggregate(const LogicalType &type, const LogicalType &result_type) -> AggregateFunction
+    {
+        auto fun = AggregateFunction::UnaryAggregateDestructor<DSHLLState, T, string_t, DSEnumCreateOperation<DSHLLEnumBindData, DSHLLCreateOperation<DSHLLBindData>>, AggregateDestructorType::LEGACY>(
+            type, result_type);
+        fun.simple_update = DSCountingSketchEnumSimpleUpdate<DSHLLState, T, DSHLLEnumBindData>;
+        return fun;
+    }
+
+    // Binds the ENUM overload, the aggregate is specialized for the physical type of
+    // the ENUM and its member strings are cached in the bind data.
+    unique_ptr<FunctionData> DSHLLEnumBind(ClientContext &context, AggregateFunction &function,
+                                                   vector<unique_ptr<Expression>> &arguments)
+    {
+        auto bind_data = DSHLLBind(context, function, arguments);
+
+        auto enum_type = arguments[0]->return_type;
+        auto result_type = function.return_type;
+        switch (enum_type.InternalType())
+        {
+        case PhysicalType::UINT8:
+            function = DSHLLCreateEnumAggregate<uint8_t>(enum_type, result_type);
+            break;
+        case PhysicalType::UINT16:
+            function = DSHLLCreateEnumAggregate<uint16_t>(enum_type, result_type);
+            break;
+        case PhysicalType::UINT32:
+            function = DSHLLCreateEnumAggregate<uint32_t>(enum_type, result_type);
+            break;
+        default:
+            throw InternalException("Unsupported ENUM physical type for HLL");
+        }
+        function.name = "datasketch_hll";
+
+        auto member_count = EnumType::GetSize(enum_type);
+        auto member_data = FlatVector::GetData<string_t>(EnumType::GetValuesInsertOrder(enum_type));
+        vector<string> members;
+        members.reserve(member_count);
+        for (idx_t i = 0; i < member_count; i++)
+        {
+            members.push_back(member_data[i].GetString());
+        }
+        return make_uniq<DSHLLEnumBindData>(bind_data->Cast<DSHLLBindData>(), std::move(members));
+    }
+    
+
 
   void LoadHLLSketch(ExtensionLoader &loader) {
 
+      
+      auto &config = DBConfig::GetConfig(loader.GetDatabaseInstance());
+      config.AddExtensionOption("datasketches_hll_compact",
+                                "Serialize the sketches made by datasketch_hll and datasketch_hll_union in the compact form",
+                                LogicalType::BOOLEAN, Value::BOOLEAN(false));
+      
+
 
       
         auto sketch_type = CreateHLLCountingSketchType(loader);
@@ -5874,6 +8569,15 @@ return sketch.get_upper_bound(std_dev_data);
                 fun.arguments.insert(fun.arguments.begin(), LogicalType::INTEGER);
                 sketch.AddFunction(fun);
             }
+            
+            {
+                auto fun = DSHLLCreateAggregate<int8_t>(LogicalType::TINYINT, sketch_type);
+                fun.bind = DSHLLBind;
+                fun.arguments.insert(fun.arguments.begin(), LogicalType::INTEGER);
+                fun.arguments.push_back(LogicalType::VARCHAR);
+                sketch.AddFunction(fun);
+            }
+            
         
         
             {
@@ -5882,6 +8586,15 @@ return sketch.get_upper_bound(std_dev_data);
                 fun.arguments.insert(fun.arguments.begin(), LogicalType::INTEGER);
                 sketch.AddFunction(fun);
             }
+            
+            {
+                auto fun = DSHLLCreateAggregate<int16_t>(LogicalType::SMALLINT, sketch_type);
+                fun.bind = DSHLLBind;
+                fun.arguments.insert(fun.arguments.begin(), LogicalType::INTEGER);
+                fun.arguments.push_back(LogicalType::VARCHAR);
+                sketch.AddFunction(fun);
+            }
+            
         
         
             {
@@ -5890,6 +8603,15 @@ return sketch.get_upper_bound(std_dev_data);
                 fun.arguments.insert(fun.arguments.begin(), LogicalType::INTEGER);
                 sketch.AddFunction(fun);
             }
+            
+            {
+                auto fun = DSHLLCreateAggregate<int32_t>(LogicalType::INTEGER, sketch_type);
+                fun.bind = DSHLLBind;
+                fun.arguments.insert(fun.arguments.begin(), LogicalType::INTEGER);
+                fun.arguments.push_back(LogicalType::VARCHAR);
+                sketch.AddFunction(fun);
+            }
+            
         
         
             {
@@ -5898,6 +8620,15 @@ return sketch.get_upper_bound(std_dev_data);
                 fun.arguments.insert(fun.arguments.begin(), LogicalType::INTEGER);
                 sketch.AddFunction(fun);
             }
+            
+            {
+                auto fun = DSHLLCreateAggregate<int64_t>(LogicalType::BIGINT, sketch_type);
+                fun.bind = DSHLLBind;
+                fun.arguments.insert(fun.arguments.begin(), LogicalType::INTEGER);
+                fun.arguments.push_back(LogicalType::VARCHAR);
+                sketch.AddFunction(fun);
+            }
+            
         
         
             {
@@ -5906,6 +8637,15 @@ return sketch.get_upper_bound(std_dev_data);
                 fun.arguments.insert(fun.arguments.begin(), LogicalType::INTEGER);
                 sketch.AddFunction(fun);
             }
+            
+            {
+                auto fun = DSHLLCreateAggregate<float>(LogicalType::FLOAT, sketch_type);
+                fun.bind = DSHLLBind;
+                fun.arguments.insert(fun.arguments.begin(), LogicalType::INTEGER);
+                fun.arguments.push_back(LogicalType::VARCHAR);
+                sketch.AddFunction(fun);
+            }
+            
         
         
             {
@@ -5914,6 +8654,15 @@ return sketch.get_upper_bound(std_dev_data);
                 fun.arguments.insert(fun.arguments.begin(), LogicalType::INTEGER);
                 sketch.AddFunction(fun);
             }
+            
+            {
+                auto fun = DSHLLCreateAggregate<double>(LogicalType::DOUBLE, sketch_type);
+                fun.bind = DSHLLBind;
+                fun.arguments.insert(fun.arguments.begin(), LogicalType::INTEGER);
+                fun.arguments.push_back(LogicalType::VARCHAR);
+                sketch.AddFunction(fun);
+            }
+            
         
         
             {
@@ -5922,6 +8671,15 @@ return sketch.get_upper_bound(std_dev_data);
                 fun.arguments.insert(fun.arguments.begin(), LogicalType::INTEGER);
                 sketch.AddFunction(fun);
             }
+            
+            {
+                auto fun = DSHLLCreateAggregate<uint8_t>(LogicalType::UTINYINT, sketch_type);
+                fun.bind = DSHLLBind;
+                fun.arguments.insert(fun.arguments.begin(), LogicalType::INTEGER);
+                fun.arguments.push_back(LogicalType::VARCHAR);
+                sketch.AddFunction(fun);
+            }
+            
         
         
             {
@@ -5930,6 +8688,15 @@ return sketch.get_upper_bound(std_dev_data);
                 fun.arguments.insert(fun.arguments.begin(), LogicalType::INTEGER);
                 sketch.AddFunction(fun);
             }
+            
+            {
+                auto fun = DSHLLCreateAggregate<uint16_t>(LogicalType::USMALLINT, sketch_type);
+                fun.bind = DSHLLBind;
+                fun.arguments.insert(fun.arguments.begin(), LogicalType::INTEGER);
+                fun.arguments.push_back(LogicalType::VARCHAR);
+                sketch.AddFunction(fun);
+            }
+            
         
         
             {
@@ -5938,6 +8705,15 @@ return sketch.get_upper_bound(std_dev_data);
                 fun.arguments.insert(fun.arguments.begin(), LogicalType::INTEGER);
                 sketch.AddFunction(fun);
             }
+            
+            {
+                auto fun = DSHLLCreateAggregate<uint32_t>(LogicalType::UINTEGER, sketch_type);
+                fun.bind = DSHLLBind;
+                fun.arguments.insert(fun.arguments.begin(), LogicalType::INTEGER);
+                fun.arguments.push_back(LogicalType::VARCHAR);
+                sketch.AddFunction(fun);
+            }
+            
         
         
             {
@@ -5946,6 +8722,15 @@ return sketch.get_upper_bound(std_dev_data);
                 fun.arguments.insert(fun.arguments.begin(), LogicalType::INTEGER);
                 sketch.AddFunction(fun);
             }
+            
+            {
+                auto fun = DSHLLCreateAggregate<uint64_t>(LogicalType::UBIGINT, sketch_type);
+                fun.bind = DSHLLBind;
+                fun.arguments.insert(fun.arguments.begin(), LogicalType::INTEGER);
+                fun.arguments.push_back(LogicalType::VARCHAR);
+                sketch.AddFunction(fun);
+            }
+            
         
         
             {
@@ -5954,6 +8739,15 @@ return sketch.get_upper_bound(std_dev_data);
                 fun.arguments.insert(fun.arguments.begin(), LogicalType::INTEGER);
                 sketch.AddFunction(fun);
             }
+            
+            {
+                auto fun = DSHLLCreateAggregate<string_t>(LogicalType::VARCHAR, sketch_type);
+                fun.bind = DSHLLBind;
+                fun.arguments.insert(fun.arguments.begin(), LogicalType::INTEGER);
+                fun.arguments.push_back(LogicalType::VARCHAR);
+                sketch.AddFunction(fun);
+            }
+            
         
         
             {
@@ -5962,7 +8756,34 @@ return sketch.get_upper_bound(std_dev_data);
                 fun.arguments.insert(fun.arguments.begin(), LogicalType::INTEGER);
                 sketch.AddFunction(fun);
             }
+            
+            {
+                auto fun = DSHLLCreateAggregate<string_t>(LogicalType::BLOB, sketch_type);
+                fun.bind = DSHLLBind;
+                fun.arguments.insert(fun.arguments.begin(), LogicalType::INTEGER);
+                fun.arguments.push_back(LogicalType::VARCHAR);
+                sketch.AddFunction(fun);
+            }
+            
         
+      
+            {
+                // ENUM values of any ENUM type, the aggregate is specialized in the bind.
+                auto fun = DSHLLCreateEnumAggregate<uint8_t>(LogicalType(LogicalTypeId::ENUM), sketch_type);
+                fun.bind = DSHLLEnumBind;
+                fun.arguments.insert(fun.arguments.begin(), LogicalType::INTEGER);
+                sketch.AddFunction(fun);
+            }
+            
+            {
+                auto fun = DSHLLCreateEnumAggregate<uint8_t>(LogicalType(LogicalTypeId::ENUM), sketch_type);
+                fun.bind = DSHLLEnumBind;
+                fun.arguments.insert(fun.arguments.begin(), LogicalType::INTEGER);
+                fun.arguments.push_back(LogicalType::VARCHAR);
+                sketch.AddFunction(fun);
+            }
+            
+      
       CreateAggregateFunctionInfo sketch_info(sketch);
 
 
@@ -5985,6 +8806,11 @@ return sketch.get_upper_bound(std_dev_data);
       fun.bind = DSHLLBind;
       fun.arguments.insert(fun.arguments.begin(), LogicalType::INTEGER);
       sketch.AddFunction(fun);
+      
+      // The optional last argument is the target type of the result.
+      fun.arguments.push_back(LogicalType::VARCHAR);
+      sketch.AddFunction(fun);
+      
       CreateAggregateFunctionInfo sketch_info(sketch);
 
     {
@@ -6013,13 +8839,33 @@ static inline void DSCPCis_empty(DataChunk &args, ExpressionState &state, Vector
 
     
         
+                    const bool sketch_is_constant = sketch_vector.GetVectorType() == VectorType::CONSTANT_VECTOR;
+                    std::optional<datasketches::cpc_sketch> constant_sketch;
+                    
         UnaryExecutor::Execute
         <string_t,bool>
         (
         sketch_vector,result,args.size(),
-        [&](string_t sketch_data) {
+        [&](string_t sketch_data) -> bool {
+
+            
+                    {
+                        DSCPCHeader header;
+                        if (DSCPCReadHeader(sketch_data.GetDataUnsafe(), sketch_data.GetSize(), header))
+                        {
+                            return header.empty;
+                        }
+                    }
+                    
 
-            auto sketch = datasketches::cpc_sketch::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize());
+                    std::optional<datasketches::cpc_sketch> row_sketch;
+                    auto &sketch_holder = sketch_is_constant ? constant_sketch : row_sketch;
+                    if (!sketch_holder)
+                    {
+                        sketch_holder.emplace(datasketches::cpc_sketch::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize()));
+                    }
+                    auto &sketch = *sketch_holder;
+                    
 return sketch.is_empty();
         });
 
@@ -6038,13 +8884,24 @@ static inline void DSCPCdescribe(DataChunk &args, ExpressionState &state, Vector
 
     
         
+                    const bool sketch_is_constant = sketch_vector.GetVectorType() == VectorType::CONSTANT_VECTOR;
+                    std::optional<datasketches::cpc_sketch> constant_sketch;
+                    
         UnaryExecutor::Execute
         <string_t,string_t>
         (
         sketch_vector,result,args.size(),
         [&](string_t sketch_data) {
 
-            auto sketch = datasketches::cpc_sketch::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize());
+            
+                    std::optional<datasketches::cpc_sketch> row_sketch;
+                    auto &sketch_holder = sketch_is_constant ? constant_sketch : row_sketch;
+                    if (!sketch_holder)
+                    {
+                        sketch_holder.emplace(datasketches::cpc_sketch::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize()));
+                    }
+                    auto &sketch = *sketch_holder;
+                    
 return StringVector::AddString(result, sketch.to_string());
         });
 
@@ -6063,13 +8920,24 @@ static inline void DSCPCestimate(DataChunk &args, ExpressionState &state, Vector
 
     
         
+                    const bool sketch_is_constant = sketch_vector.GetVectorType() == VectorType::CONSTANT_VECTOR;
+                    std::optional<datasketches::cpc_sketch> constant_sketch;
+                    
         UnaryExecutor::Execute
         <string_t,double>
         (
         sketch_vector,result,args.size(),
         [&](string_t sketch_data) {
 
-            auto sketch = datasketches::cpc_sketch::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize());
+            
+                    std::optional<datasketches::cpc_sketch> row_sketch;
+                    auto &sketch_holder = sketch_is_constant ? constant_sketch : row_sketch;
+                    if (!sketch_holder)
+                    {
+                        sketch_holder.emplace(datasketches::cpc_sketch::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize()));
+                    }
+                    auto &sketch = *sketch_holder;
+                    
 return sketch.get_estimate();
         });
 
@@ -6089,13 +8957,24 @@ static inline void DSCPClower_bound(DataChunk &args, ExpressionState &state, Vec
 
     
         
+                    const bool sketch_is_constant = sketch_vector.GetVectorType() == VectorType::CONSTANT_VECTOR;
+                    std::optional<datasketches::cpc_sketch> constant_sketch;
+                    
         BinaryExecutor::Execute
         <string_t,uint8_t,double>
         (
         sketch_vector,std_dev_vector,result,args.size(),
         [&](string_t sketch_data,uint8_t std_dev_data) {
 
-            auto sketch = datasketches::cpc_sketch::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize());
+            
+                    std::optional<datasketches::cpc_sketch> row_sketch;
+                    auto &sketch_holder = sketch_is_constant ? constant_sketch : row_sketch;
+                    if (!sketch_holder)
+                    {
+                        sketch_holder.emplace(datasketches::cpc_sketch::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize()));
+                    }
+                    auto &sketch = *sketch_holder;
+                    
 return sketch.get_lower_bound(std_dev_data);
         });
 
@@ -6115,13 +8994,24 @@ static inline void DSCPCupper_bound(DataChunk &args, ExpressionState &state, Vec
 
     
         
+                    const bool sketch_is_constant = sketch_vector.GetVectorType() == VectorType::CONSTANT_VECTOR;
+                    std::optional<datasketches::cpc_sketch> constant_sketch;
+                    
         BinaryExecutor::Execute
         <string_t,uint8_t,double>
         (
         sketch_vector,std_dev_vector,result,args.size(),
         [&](string_t sketch_data,uint8_t std_dev_data) {
 
-            auto sketch = datasketches::cpc_sketch::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize());
+            
+                    std::optional<datasketches::cpc_sketch> row_sketch;
+                    auto &sketch_holder = sketch_is_constant ? constant_sketch : row_sketch;
+                    if (!sketch_holder)
+                    {
+                        sketch_holder.emplace(datasketches::cpc_sketch::deserialize(sketch_data.GetDataUnsafe(), sketch_data.GetSize()));
+                    }
+                    auto &sketch = *sketch_holder;
+                    
 return sketch.get_upper_bound(std_dev_data);
         });
 
@@ -6146,14 +9036,66 @@ return sketch.get_upper_bound(std_dev_data);
     auto static DSCPCCreateAggregate(const LogicalType &type, const LogicalType &result_type) -> AggregateFunction
     {
         
-        return AggregateFunction::UnaryAggregateDestructor<DSCPCState, T, string_t, DSCPCCreateOperation<DSCPCBindData>, AggregateDestructorType::LEGACY>(
+        auto fun = AggregateFunction::UnaryAggregateDestructor<DSCPCState, T, string_t, DSCPCCreateOperation<DSCPCBindData>, AggregateDestructorType::LEGACY>(
             type, result_type);
+        fun.simple_update = DSCountingSketchSimpleUpdate<DSCPCState, T, DSCPCBindData>;
+        return fun;
         
     }
 
+    
+    
+    template <typename T>
+    auto static DSCPCCreateEnumAggregate(const LogicalType &type, const LogicalType &result_type) -> AggregateFunction
+    {
+        auto fun = AggregateFunction::UnaryAggregateDestructor<DSCPCState, T, string_t, DSEnumCreateOperation<DSCPCEnumBindData, DSCPCCreateOperation<DSCPCBindData>>, AggregateDestructorType::LEGACY>(
+            type, result_type);
+        fun.simple_update = DSCountingSketchEnumSimpleUpdate<DSCPCState, T, DSCPCEnumBindData>;
+        return fun;
+    }
+
+    // Binds the ENUM overload, the aggregate is specialized for the physical type of
+    // the ENUM and its member strings are cached in the bind data.
+    unique_ptr<FunctionData> DSCPCEnumBind(ClientContext &context, AggregateFunction &function,
+                                                   vector<unique_ptr<Expression>> &arguments)
+    {
+        auto bind_data = DSCPCBind(context, function, arguments);
+
+        auto enum_type = arguments[0]->return_type;
+        auto result_type = function.return_type;
+        switch (enum_type.InternalType())
+        {
+        case PhysicalType::UINT8:
+            function = DSCPCCreateEnumAggregate<uint8_t>(enum_type, result_type);
+            break;
+        case PhysicalType::UINT16:
+            function = DSCPCCreateEnumAggregate<uint16_t>(enum_type, result_type);
+            break;
+        case PhysicalType::UINT32:
+            function = DSCPCCreateEnumAggregate<uint32_t>(enum_type, result_type);
+            break;
+        default:
+            throw InternalException("Unsupported ENUM physical type for CPC");
+        }
+        function.name = "datasketch_cpc";
+
+        auto member_count = EnumType::GetSize(enum_type);
+        auto member_data = FlatVector::GetData<string_t>(EnumType::GetValuesInsertOrder(enum_type));
+        vector<string> members;
+        members.reserve(member_count);
+        for (idx_t i = 0; i < member_count; i++)
+        {
+            members.push_back(member_data[i].GetString());
+        }
+        return make_uniq<DSCPCEnumBindData>(bind_data->Cast<DSCPCBindData>(), std::move(members));
+    }
+    
+
 
   void LoadCPCSketch(ExtensionLoader &loader) {
 
+      
+
 
       
         auto sketch_type = CreateCPCCountingSketchType(loader);
@@ -6277,6 +9219,7 @@ return sketch.get_upper_bound(std_dev_data);
                 fun.arguments.insert(fun.arguments.begin(), LogicalType::INTEGER);
                 sketch.AddFunction(fun);
             }
+            
         
         
             {
@@ -6285,6 +9228,7 @@ return sketch.get_upper_bound(std_dev_data);
                 fun.arguments.insert(fun.arguments.begin(), LogicalType::INTEGER);
                 sketch.AddFunction(fun);
             }
+            
         
         
             {
@@ -6293,6 +9237,7 @@ return sketch.get_upper_bound(std_dev_data);
                 fun.arguments.insert(fun.arguments.begin(), LogicalType::INTEGER);
                 sketch.AddFunction(fun);
             }
+            
         
         
             {
@@ -6301,6 +9246,7 @@ return sketch.get_upper_bound(std_dev_data);
                 fun.arguments.insert(fun.arguments.begin(), LogicalType::INTEGER);
                 sketch.AddFunction(fun);
             }
+            
         
         
             {
@@ -6309,6 +9255,7 @@ return sketch.get_upper_bound(std_dev_data);
                 fun.arguments.insert(fun.arguments.begin(), LogicalType::INTEGER);
                 sketch.AddFunction(fun);
             }
+            
         
         
             {
@@ -6317,6 +9264,7 @@ return sketch.get_upper_bound(std_dev_data);
                 fun.arguments.insert(fun.arguments.begin(), LogicalType::INTEGER);
                 sketch.AddFunction(fun);
             }
+            
         
         
             {
@@ -6325,6 +9273,7 @@ return sketch.get_upper_bound(std_dev_data);
                 fun.arguments.insert(fun.arguments.begin(), LogicalType::INTEGER);
                 sketch.AddFunction(fun);
             }
+            
         
         
             {
@@ -6333,6 +9282,7 @@ return sketch.get_upper_bound(std_dev_data);
                 fun.arguments.insert(fun.arguments.begin(), LogicalType::INTEGER);
                 sketch.AddFunction(fun);
             }
+            
         
         
             {
@@ -6341,6 +9291,7 @@ return sketch.get_upper_bound(std_dev_data);
                 fun.arguments.insert(fun.arguments.begin(), LogicalType::INTEGER);
                 sketch.AddFunction(fun);
             }
+            
         
         
             {
@@ -6349,6 +9300,7 @@ return sketch.get_upper_bound(std_dev_data);
                 fun.arguments.insert(fun.arguments.begin(), LogicalType::INTEGER);
                 sketch.AddFunction(fun);
             }
+            
         
         
             {
@@ -6357,6 +9309,7 @@ return sketch.get_upper_bound(std_dev_data);
                 fun.arguments.insert(fun.arguments.begin(), LogicalType::INTEGER);
                 sketch.AddFunction(fun);
             }
+            
         
         
             {
@@ -6365,7 +9318,18 @@ return sketch.get_upper_bound(std_dev_data);
                 fun.arguments.insert(fun.arguments.begin(), LogicalType::INTEGER);
                 sketch.AddFunction(fun);
             }
+            
         
+      
+            {
+                // ENUM values of any ENUM type, the aggregate is specialized in the bind.
+                auto fun = DSCPCCreateEnumAggregate<uint8_t>(LogicalType(LogicalTypeId::ENUM), sketch_type);
+                fun.bind = DSCPCEnumBind;
+                fun.arguments.insert(fun.arguments.begin(), LogicalType::INTEGER);
+                sketch.AddFunction(fun);
+            }
+            
+      
       CreateAggregateFunctionInfo sketch_info(sketch);
 
 
@@ -6388,6 +9352,7 @@ return sketch.get_upper_bound(std_dev_data);
       fun.bind = DSCPCBind;
       fun.arguments.insert(fun.arguments.begin(), LogicalType::INTEGER);
       sketch.AddFunction(fun);
+      
       CreateAggregateFunctionInfo sketch_info(sketch);
 
     {
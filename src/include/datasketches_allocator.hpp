@@ -0,0 +1,305 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/storage/arena_allocator.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace duckdb_datasketches
+{
+
+    // Memory for the sketches of one aggregate state. Blocks are carved out of the
+    // aggregate's ArenaAllocator, which frees all of them at once when the aggregate's
+    // data is destroyed. The sketches replace some of their buffers over and over
+    // while they are updated, so blocks that are given back are kept on a free list
+    // per size class and handed out again for an allocation of the same class. The
+    // size classes are the powers of two, a buffer that grows leaves its smaller
+    // blocks on their free lists where another buffer of the state may take them.
+    //
+    // The aggregate arenas take their memory from DuckDB's buffer allocator, so the
+    // sketches count against memory_limit and are reported by duckdb_memory() with
+    // the rest of the aggregate's data.
+    //
+    // An arena is only used by the thread that works on its aggregate data, so the
+    // pools take no lock. A pool must therefore only be reached through the sketches
+    // of its own state: the sketches kept in a pool (KLL, REQ and TDigest) allocate
+    // through their own allocator when another sketch is merged into them, never
+    // through the source's. Sketches that copy a merged source with the source's
+    // allocator (classic quantiles, HLL and CPC) use DSBufferAllocator instead.
+    class DSArenaPool
+    {
+    public:
+        explicit DSArenaPool(duckdb::ArenaAllocator &arena) : arena(&arena)
+        {
+        }
+
+        // Create a pool that lives in the arena itself.
+        static DSArenaPool *Create(duckdb::ArenaAllocator &arena)
+        {
+            return new (arena.AllocateAligned(sizeof(DSArenaPool))) DSArenaPool(arena);
+        }
+
+        void *Allocate(size_t size)
+        {
+            auto size_class = SizeClass(size);
+            if (size_class < SIZE_CLASSES && free_lists[size_class])
+            {
+                auto block = free_lists[size_class];
+                free_lists[size_class] = block->next;
+                return block;
+            }
+            return arena->AllocateAligned(MIN_BLOCK_SIZE << size_class);
+        }
+
+        void Deallocate(void *ptr, size_t size)
+        {
+            auto size_class = SizeClass(size);
+            if (released || size_class >= SIZE_CLASSES)
+            {
+                return;
+            }
+            auto block = static_cast<FreeBlock *>(ptr);
+            block->next = free_lists[size_class];
+            free_lists[size_class] = block;
+        }
+
+        // Take further blocks from another arena. This is used when a state in another
+        // aggregate arena, which may belong to another thread, takes over the sketches.
+        void SetArena(duckdb::ArenaAllocator &new_arena)
+        {
+            arena = &new_arena;
+        }
+
+        // Stop keeping the blocks that are given back, the state is being destroyed and
+        // the arena frees its memory anyway.
+        void Release()
+        {
+            released = true;
+        }
+
+    private:
+        struct FreeBlock
+        {
+            FreeBlock *next;
+        };
+
+        static constexpr size_t MIN_BLOCK_SIZE = 16;
+        // Blocks of the classes above the last one, 8 TiB, are not kept for reuse.
+        static constexpr size_t SIZE_CLASSES = 40;
+
+        // The size class of an allocation, its block has MIN_BLOCK_SIZE << class bytes.
+        static size_t SizeClass(size_t size)
+        {
+            size_t size_class = 0;
+            while ((MIN_BLOCK_SIZE << size_class) < size)
+            {
+                size_class++;
+            }
+            return size_class;
+        }
+
+        duckdb::ArenaAllocator *arena;
+        FreeBlock *free_lists[SIZE_CLASSES] = {};
+        bool released = false;
+    };
+
+    // Allocator for the DataSketches templates that takes its memory from a
+    // DSArenaPool. A default constructed allocator has no pool and uses the heap, that
+    // is what the short lived sketches deserialized while merging use.
+    template <class T>
+    class DSArenaAllocator
+    {
+    public:
+        using value_type = T;
+        using propagate_on_container_copy_assignment = std::true_type;
+        using propagate_on_container_move_assignment = std::true_type;
+        using propagate_on_container_swap = std::true_type;
+
+        DSArenaAllocator() = default;
+
+        explicit DSArenaAllocator(DSArenaPool *pool) : pool(pool)
+        {
+        }
+
+        template <class U>
+        DSArenaAllocator(const DSArenaAllocator<U> &other) : pool(other.pool)
+        {
+        }
+
+        T *allocate(size_t n)
+        {
+            if (!pool)
+            {
+                return std::allocator<T>().allocate(n);
+            }
+            return static_cast<T *>(pool->Allocate(n * sizeof(T)));
+        }
+
+        void deallocate(T *ptr, size_t n)
+        {
+            if (!pool)
+            {
+                std::allocator<T>().deallocate(ptr, n);
+                return;
+            }
+            pool->Deallocate(ptr, n * sizeof(T));
+        }
+
+        template <class U>
+        bool operator==(const DSArenaAllocator<U> &other) const
+        {
+            return pool == other.pool;
+        }
+
+        template <class U>
+        bool operator!=(const DSArenaAllocator<U> &other) const
+        {
+            return pool != other.pool;
+        }
+
+    private:
+        template <class U>
+        friend class DSArenaAllocator;
+
+        DSArenaPool *pool = nullptr;
+    };
+
+    // Allocator for the DataSketches templates that takes its memory from DuckDB's
+    // buffer allocator, which counts it against memory_limit. It is used for the
+    // classic quantiles and distinct counting sketches: they copy a merged sketch
+    // through that sketch's own allocator and keep the copy, so they could otherwise
+    // take blocks from the arena of a source state on another thread. A default
+    // constructed allocator has no buffer allocator and uses the heap.
+    template <class T>
+    class DSBufferAllocator
+    {
+    public:
+        using value_type = T;
+        using propagate_on_container_copy_assignment = std::true_type;
+        using propagate_on_container_move_assignment = std::true_type;
+        using propagate_on_container_swap = std::true_type;
+
+        DSBufferAllocator() = default;
+
+        explicit DSBufferAllocator(duckdb::Allocator *allocator) : allocator(allocator)
+        {
+        }
+
+        template <class U>
+        DSBufferAllocator(const DSBufferAllocator<U> &other) : allocator(other.allocator)
+        {
+        }
+
+        T *allocate(size_t n)
+        {
+            if (!allocator)
+            {
+                return std::allocator<T>().allocate(n);
+            }
+            return reinterpret_cast<T *>(allocator->AllocateData(n * sizeof(T)));
+        }
+
+        void deallocate(T *ptr, size_t n)
+        {
+            if (!allocator)
+            {
+                std::allocator<T>().deallocate(ptr, n);
+                return;
+            }
+            allocator->FreeData(reinterpret_cast<duckdb::data_ptr_t>(ptr), n * sizeof(T));
+        }
+
+        template <class U>
+        bool operator==(const DSBufferAllocator<U> &other) const
+        {
+            return allocator == other.allocator;
+        }
+
+        template <class U>
+        bool operator!=(const DSBufferAllocator<U> &other) const
+        {
+            return allocator != other.allocator;
+        }
+
+    private:
+        template <class U>
+        friend class DSBufferAllocator;
+
+        duckdb::Allocator *allocator = nullptr;
+    };
+
+
+    // An object kept inside an aggregate state and constructed on first use. Only the
+    // object's bytes and a flag are stored, never a pointer into the state, because
+    // DuckDB may relocate aggregate states with a plain copy of their bytes.
+    template <class T>
+    class DSInline
+    {
+    public:
+        template <class... ARGS>
+        T &Construct(ARGS &&...args)
+        {
+            D_ASSERT(!constructed);
+            new (storage) T(std::forward<ARGS>(args)...);
+            constructed = true;
+            return Get();
+        }
+
+        void Destroy()
+        {
+            if (constructed)
+            {
+                Get().~T();
+                constructed = false;
+            }
+        }
+
+        explicit operator bool() const
+        {
+            return constructed;
+        }
+
+        T &operator*()
+        {
+            D_ASSERT(constructed);
+            return Get();
+        }
+
+        const T &operator*() const
+        {
+            D_ASSERT(constructed);
+            return Get();
+        }
+
+        T *operator->()
+        {
+            return &**this;
+        }
+
+        const T *operator->() const
+        {
+            return &**this;
+        }
+
+    private:
+        T &Get()
+        {
+            return *std::launder(reinterpret_cast<T *>(storage));
+        }
+
+        const T &Get() const
+        {
+            return *std::launder(reinterpret_cast<const T *>(storage));
+        }
+
+        alignas(T) unsigned char storage[sizeof(T)];
+        bool constructed = false;
+    };
+
+}
@@ -0,0 +1,809 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace duckdb_datasketches
+{
+
+    // Readers for the serialized form of the sketches. These answer questions or feed
+    // items straight from the bytes of a stored sketch without deserializing it. Each
+    // reader checks every byte it relies on and reports when a sketch is outside of
+    // what it handles, the caller then falls back to the library's deserialization,
+    // which also raises the proper error for malformed input.
+
+    template <class T>
+    static inline T DSLoad(const uint8_t *ptr)
+    {
+        T value;
+        memcpy(&value, ptr, sizeof(T));
+        return value;
+    }
+
+    // Layout of a serialized KLL sketch.
+    struct DSKLLLayout
+    {
+        static constexpr uint8_t FAMILY = 15;
+        static constexpr uint8_t PREAMBLE_INTS_FULL = 5;
+        static constexpr uint8_t SERIAL_VERSION_FULL = 1;
+        static constexpr uint8_t SERIAL_VERSION_SINGLE_ITEM = 2;
+        static constexpr uint8_t DEFAULT_M = 8;
+
+        static constexpr uint8_t FLAG_EMPTY = 1 << 0;
+        static constexpr uint8_t FLAG_SINGLE_ITEM = 1 << 2;
+
+        static constexpr size_t PREAMBLE_INTS_BYTE = 0;
+        static constexpr size_t SERIAL_VERSION_BYTE = 1;
+        static constexpr size_t FAMILY_BYTE = 2;
+        static constexpr size_t FLAGS_BYTE = 3;
+        static constexpr size_t K_SHORT = 4;
+        static constexpr size_t M_BYTE = 6;
+        static constexpr size_t N_LONG = 8;
+        static constexpr size_t NUM_LEVELS_BYTE = 18;
+
+        static constexpr size_t DATA_START_SINGLE_ITEM = 8;
+        static constexpr size_t DATA_START = 20;
+    };
+
+    // Layout of a serialized classic quantiles sketch.
+    struct DSQuantilesLayout
+    {
+        static constexpr uint8_t FAMILY = 8;
+        static constexpr uint8_t PREAMBLE_LONGS_FULL = 2;
+        static constexpr uint8_t SERIAL_VERSION = 3;
+
+        static constexpr uint8_t FLAG_EMPTY = 1 << 2;
+
+        static constexpr uint16_t MIN_K = 2;
+        static constexpr uint16_t MAX_K = 1 << 15;
+
+        static constexpr size_t PREAMBLE_LONGS_BYTE = 0;
+        static constexpr size_t SERIAL_VERSION_BYTE = 1;
+        static constexpr size_t FAMILY_BYTE = 2;
+        static constexpr size_t FLAGS_BYTE = 3;
+        static constexpr size_t K_SHORT = 4;
+        static constexpr size_t N_LONG = 8;
+
+        static constexpr size_t EMPTY_SIZE = 8;
+        static constexpr size_t DATA_START = 16;
+    };
+
+    // Layout of a serialized REQ sketch.
+    struct DSREQLayout
+    {
+        static constexpr uint8_t FAMILY = 17;
+        static constexpr uint8_t SERIAL_VERSION = 1;
+        static constexpr uint8_t PREAMBLE_INTS_EXACT = 2;
+        static constexpr uint8_t PREAMBLE_INTS_ESTIMATION = 4;
+        static constexpr uint8_t MAX_RAW_ITEMS = 4;
+
+        static constexpr uint8_t FLAG_EMPTY = 1 << 2;
+        static constexpr uint8_t FLAG_RAW_ITEMS = 1 << 4;
+
+        static constexpr uint16_t MIN_K = 4;
+        static constexpr uint16_t MAX_K = 1024;
+
+        static constexpr size_t PREAMBLE_INTS_BYTE = 0;
+        static constexpr size_t SERIAL_VERSION_BYTE = 1;
+        static constexpr size_t FAMILY_BYTE = 2;
+        static constexpr size_t FLAGS_BYTE = 3;
+        static constexpr size_t K_SHORT = 4;
+        static constexpr size_t NUM_LEVELS_BYTE = 6;
+        static constexpr size_t NUM_RAW_ITEMS_BYTE = 7;
+        static constexpr size_t N_LONG = 8;
+
+        static constexpr size_t DATA_START = 8;
+    };
+
+    // Layout of a serialized t-digest.
+    struct DSTDigestLayout
+    {
+        static constexpr uint8_t FAMILY = 20;
+        static constexpr uint8_t SERIAL_VERSION = 1;
+        static constexpr uint8_t PREAMBLE_LONGS_EMPTY_OR_SINGLE = 1;
+
+        static constexpr uint8_t FLAG_EMPTY = 1 << 0;
+        static constexpr uint8_t FLAG_SINGLE_VALUE = 1 << 1;
+
+        static constexpr uint16_t MIN_K = 10;
+
+        static constexpr size_t PREAMBLE_LONGS_BYTE = 0;
+        static constexpr size_t SERIAL_VERSION_BYTE = 1;
+        static constexpr size_t FAMILY_BYTE = 2;
+        static constexpr size_t K_SHORT = 3;
+        static constexpr size_t FLAGS_BYTE = 5;
+
+        static constexpr size_t DATA_START = 8;
+    };
+
+    // What the preamble of a stored sketch tells about it. Fields that a family or a
+    // form of the sketch does not record in its preamble come with a flag that says
+    // whether they were read.
+    struct DSKLLHeader
+    {
+        bool empty;
+        uint16_t k;
+        uint64_t n;
+        uint64_t num_retained;
+        bool estimation_mode;
+    };
+
+    struct DSQuantilesHeader
+    {
+        bool empty;
+        uint16_t k;
+        uint64_t n;
+        uint64_t num_retained;
+        bool estimation_mode;
+    };
+
+    struct DSREQHeader
+    {
+        bool empty;
+        uint16_t k;
+        bool estimation_mode;
+        bool has_n;
+        uint64_t n;
+        bool has_num_retained;
+        uint64_t num_retained;
+    };
+
+    struct DSTDigestHeader
+    {
+        bool empty;
+        uint16_t k;
+        bool has_total_weight;
+        uint64_t total_weight;
+    };
+
+    // Read the preamble of a serialized KLL sketch. The number of retained items
+    // follows from the size of the sketch and the number of levels. Returns false for
+    // anything that the library would not deserialize the same way.
+    template <class T>
+    static bool DSKLLReadHeader(const char *data, size_t size, DSKLLHeader &header)
+    {
+        static_assert(std::is_arithmetic<T>::value, "items must be stored as plain values");
+        auto bytes = reinterpret_cast<const uint8_t *>(data);
+        if (size < DSKLLLayout::DATA_START_SINGLE_ITEM || bytes[DSKLLLayout::FAMILY_BYTE] != DSKLLLayout::FAMILY ||
+            bytes[DSKLLLayout::M_BYTE] != DSKLLLayout::DEFAULT_M)
+        {
+            return false;
+        }
+        header.k = DSLoad<uint16_t>(bytes + DSKLLLayout::K_SHORT);
+        if (header.k < DSKLLLayout::DEFAULT_M)
+        {
+            return false;
+        }
+
+        const auto flags = bytes[DSKLLLayout::FLAGS_BYTE];
+        const auto serial_version = bytes[DSKLLLayout::SERIAL_VERSION_BYTE];
+        if (flags & DSKLLLayout::FLAG_EMPTY)
+        {
+            header.empty = true;
+            header.n = 0;
+            header.num_retained = 0;
+            header.estimation_mode = false;
+            return serial_version == DSKLLLayout::SERIAL_VERSION_FULL && size == DSKLLLayout::DATA_START_SINGLE_ITEM;
+        }
+        header.empty = false;
+        if (flags & DSKLLLayout::FLAG_SINGLE_ITEM)
+        {
+            header.n = 1;
+            header.num_retained = 1;
+            header.estimation_mode = false;
+            return serial_version == DSKLLLayout::SERIAL_VERSION_SINGLE_ITEM &&
+                   size == DSKLLLayout::DATA_START_SINGLE_ITEM + sizeof(T);
+        }
+
+        // The levels array without its last offset, min and max come before the items.
+        if (size < DSKLLLayout::DATA_START)
+        {
+            return false;
+        }
+        const size_t num_levels = bytes[DSKLLLayout::NUM_LEVELS_BYTE];
+        const size_t items_start = DSKLLLayout::DATA_START + num_levels * sizeof(uint32_t) + 2 * sizeof(T);
+        if (serial_version != DSKLLLayout::SERIAL_VERSION_FULL ||
+            bytes[DSKLLLayout::PREAMBLE_INTS_BYTE] != DSKLLLayout::PREAMBLE_INTS_FULL || num_levels == 0 ||
+            size < items_start || (size - items_start) % sizeof(T) != 0)
+        {
+            return false;
+        }
+        header.n = DSLoad<uint64_t>(bytes + DSKLLLayout::N_LONG);
+        header.num_retained = (size - items_start) / sizeof(T);
+        header.estimation_mode = num_levels > 1;
+        return header.num_retained > 0 && header.num_retained <= header.n;
+    }
+
+    // Read the preamble of a serialized classic quantiles sketch. The retained items
+    // are the partly filled base buffer and a full level of k items for every bit of
+    // n / 2k, the sketch's size is checked against that count.
+    template <class T>
+    static bool DSQuantilesReadHeader(const char *data, size_t size, DSQuantilesHeader &header)
+    {
+        static_assert(std::is_arithmetic<T>::value, "items must be stored as plain values");
+        auto bytes = reinterpret_cast<const uint8_t *>(data);
+        if (size < DSQuantilesLayout::EMPTY_SIZE || bytes[DSQuantilesLayout::FAMILY_BYTE] != DSQuantilesLayout::FAMILY ||
+            bytes[DSQuantilesLayout::SERIAL_VERSION_BYTE] != DSQuantilesLayout::SERIAL_VERSION)
+        {
+            return false;
+        }
+        header.k = DSLoad<uint16_t>(bytes + DSQuantilesLayout::K_SHORT);
+        if (header.k < DSQuantilesLayout::MIN_K || header.k > DSQuantilesLayout::MAX_K || (header.k & (header.k - 1)))
+        {
+            return false;
+        }
+        if (bytes[DSQuantilesLayout::FLAGS_BYTE] & DSQuantilesLayout::FLAG_EMPTY)
+        {
+            header.empty = true;
+            header.n = 0;
+            header.num_retained = 0;
+            header.estimation_mode = false;
+            return size == DSQuantilesLayout::EMPTY_SIZE;
+        }
+        if (bytes[DSQuantilesLayout::PREAMBLE_LONGS_BYTE] != DSQuantilesLayout::PREAMBLE_LONGS_FULL ||
+            size < DSQuantilesLayout::DATA_START)
+        {
+            return false;
+        }
+        const uint64_t two_k = 2 * static_cast<uint64_t>(header.k);
+        header.empty = false;
+        header.n = DSLoad<uint64_t>(bytes + DSQuantilesLayout::N_LONG);
+        uint64_t levels = 0;
+        for (auto bit_pattern = header.n / two_k; bit_pattern; bit_pattern &= bit_pattern - 1)
+        {
+            levels++;
+        }
+        header.num_retained = header.n % two_k + levels * header.k;
+        header.estimation_mode = header.n >= two_k;
+        return header.n > 0 &&
+               size == DSQuantilesLayout::DATA_START + (2 + header.num_retained) * sizeof(T);
+    }
+
+    // Read the preamble of a serialized REQ sketch. Only sketches with raw items and
+    // sketches in estimation mode record n in their preamble, and only the first also
+    // tell their number of retained items without walking the compactors.
+    template <class T>
+    static bool DSREQReadHeader(const char *data, size_t size, DSREQHeader &header)
+    {
+        static_assert(std::is_arithmetic<T>::value, "items must be stored as plain values");
+        auto bytes = reinterpret_cast<const uint8_t *>(data);
+        if (size < DSREQLayout::DATA_START || bytes[DSREQLayout::FAMILY_BYTE] != DSREQLayout::FAMILY ||
+            bytes[DSREQLayout::SERIAL_VERSION_BYTE] != DSREQLayout::SERIAL_VERSION)
+        {
+            return false;
+        }
+        header.k = DSLoad<uint16_t>(bytes + DSREQLayout::K_SHORT);
+        if (header.k < DSREQLayout::MIN_K || header.k > DSREQLayout::MAX_K || header.k % 2 != 0)
+        {
+            return false;
+        }
+
+        const auto preamble_ints = bytes[DSREQLayout::PREAMBLE_INTS_BYTE];
+        const auto flags = bytes[DSREQLayout::FLAGS_BYTE];
+        const auto num_levels = bytes[DSREQLayout::NUM_LEVELS_BYTE];
+        header.has_n = false;
+        header.has_num_retained = false;
+        if (flags & DSREQLayout::FLAG_EMPTY)
+        {
+            header.empty = true;
+            header.estimation_mode = false;
+            header.has_n = true;
+            header.n = 0;
+            header.has_num_retained = true;
+            header.num_retained = 0;
+            return preamble_ints == DSREQLayout::PREAMBLE_INTS_EXACT && size == DSREQLayout::DATA_START;
+        }
+        header.empty = false;
+        if (preamble_ints == DSREQLayout::PREAMBLE_INTS_ESTIMATION)
+        {
+            if (num_levels <= 1 || size < DSREQLayout::N_LONG + sizeof(uint64_t) + 2 * sizeof(T))
+            {
+                return false;
+            }
+            header.estimation_mode = true;
+            header.has_n = true;
+            header.n = DSLoad<uint64_t>(bytes + DSREQLayout::N_LONG);
+            return true;
+        }
+        if (preamble_ints != DSREQLayout::PREAMBLE_INTS_EXACT || num_levels != 1)
+        {
+            return false;
+        }
+        header.estimation_mode = false;
+        if (flags & DSREQLayout::FLAG_RAW_ITEMS)
+        {
+            const auto num_raw_items = bytes[DSREQLayout::NUM_RAW_ITEMS_BYTE];
+            header.has_n = true;
+            header.n = num_raw_items;
+            header.has_num_retained = true;
+            header.num_retained = num_raw_items;
+            return num_raw_items > 0 && num_raw_items <= DSREQLayout::MAX_RAW_ITEMS &&
+                   size == DSREQLayout::DATA_START + num_raw_items * sizeof(T);
+        }
+        return true;
+    }
+
+    // Read the preamble of a serialized t-digest. Its total weight is only read for an
+    // empty or a single value digest, the weights of the centroids of a larger digest
+    // are left to the library.
+    static inline bool DSTDigestReadHeader(const char *data, size_t size, DSTDigestHeader &header)
+    {
+        auto bytes = reinterpret_cast<const uint8_t *>(data);
+        if (size < DSTDigestLayout::DATA_START || bytes[DSTDigestLayout::FAMILY_BYTE] != DSTDigestLayout::FAMILY ||
+            bytes[DSTDigestLayout::SERIAL_VERSION_BYTE] != DSTDigestLayout::SERIAL_VERSION)
+        {
+            return false;
+        }
+        header.k = DSLoad<uint16_t>(bytes + DSTDigestLayout::K_SHORT);
+        if (header.k < DSTDigestLayout::MIN_K)
+        {
+            return false;
+        }
+
+        const auto flags = bytes[DSTDigestLayout::FLAGS_BYTE];
+        const bool empty_or_single = bytes[DSTDigestLayout::PREAMBLE_LONGS_BYTE] == DSTDigestLayout::PREAMBLE_LONGS_EMPTY_OR_SINGLE;
+        header.empty = flags & DSTDigestLayout::FLAG_EMPTY;
+        header.has_total_weight = false;
+        if (header.empty)
+        {
+            header.has_total_weight = true;
+            header.total_weight = 0;
+            return empty_or_single && size == DSTDigestLayout::DATA_START;
+        }
+        if (flags & DSTDigestLayout::FLAG_SINGLE_VALUE)
+        {
+            header.has_total_weight = true;
+            header.total_weight = 1;
+            return empty_or_single && size > DSTDigestLayout::DATA_START;
+        }
+        return !empty_or_single && size > DSTDigestLayout::DATA_START;
+    }
+
+    // Feed the items of a serialized KLL sketch that has not compacted yet to
+    // sketch.update(). For an empty sketch, a single item sketch or a sketch with a
+    // single level this is what kll_sketch::merge() does with the items, so the
+    // result is the same as merging the deserialized sketch. Returns false, without
+    // touching the sketch, for anything else.
+    template <class T, class SKETCH>
+    static bool DSKLLUpdateFromExact(SKETCH &sketch, const char *data, size_t size)
+    {
+        static_assert(std::is_arithmetic<T>::value, "items must be stored as plain values");
+        auto bytes = reinterpret_cast<const uint8_t *>(data);
+        if (size < DSKLLLayout::DATA_START_SINGLE_ITEM || bytes[DSKLLLayout::FAMILY_BYTE] != DSKLLLayout::FAMILY ||
+            bytes[DSKLLLayout::M_BYTE] != DSKLLLayout::DEFAULT_M)
+        {
+            return false;
+        }
+
+        const auto flags = bytes[DSKLLLayout::FLAGS_BYTE];
+        const auto serial_version = bytes[DSKLLLayout::SERIAL_VERSION_BYTE];
+        if (flags & DSKLLLayout::FLAG_EMPTY)
+        {
+            return serial_version == DSKLLLayout::SERIAL_VERSION_FULL && size == DSKLLLayout::DATA_START_SINGLE_ITEM;
+        }
+        if (flags & DSKLLLayout::FLAG_SINGLE_ITEM)
+        {
+            if (serial_version != DSKLLLayout::SERIAL_VERSION_SINGLE_ITEM ||
+                size != DSKLLLayout::DATA_START_SINGLE_ITEM + sizeof(T))
+            {
+                return false;
+            }
+            sketch.update(DSLoad<T>(bytes + DSKLLLayout::DATA_START_SINGLE_ITEM));
+            return true;
+        }
+
+        // A single level holds the levels array with one offset, min, max and then all items.
+        constexpr size_t items_start = DSKLLLayout::DATA_START + sizeof(uint32_t) + 2 * sizeof(T);
+        if (serial_version != DSKLLLayout::SERIAL_VERSION_FULL ||
+            bytes[DSKLLLayout::PREAMBLE_INTS_BYTE] != DSKLLLayout::PREAMBLE_INTS_FULL || size < items_start ||
+            bytes[DSKLLLayout::NUM_LEVELS_BYTE] != 1)
+        {
+            return false;
+        }
+        const auto n = DSLoad<uint64_t>(bytes + DSKLLLayout::N_LONG);
+        if ((size - items_start) % sizeof(T) != 0 || n != (size - items_start) / sizeof(T))
+        {
+            return false;
+        }
+        auto items = bytes + items_start;
+        for (uint64_t i = 0; i < n; i++)
+        {
+            sketch.update(DSLoad<T>(items + i * sizeof(T)));
+        }
+        return true;
+    }
+
+    // Feed the items of a serialized classic quantiles sketch that is not in estimation
+    // mode to sketch.update(). quantiles_sketch::merge() streams the items of such a
+    // sketch into update() as well, so the result is the same as merging the
+    // deserialized sketch. Returns false, without touching the sketch, for anything else.
+    template <class T, class SKETCH>
+    static bool DSQuantilesUpdateFromExact(SKETCH &sketch, const char *data, size_t size)
+    {
+        static_assert(std::is_arithmetic<T>::value, "items must be stored as plain values");
+        auto bytes = reinterpret_cast<const uint8_t *>(data);
+        if (size < DSQuantilesLayout::EMPTY_SIZE || bytes[DSQuantilesLayout::FAMILY_BYTE] != DSQuantilesLayout::FAMILY ||
+            bytes[DSQuantilesLayout::SERIAL_VERSION_BYTE] != DSQuantilesLayout::SERIAL_VERSION)
+        {
+            return false;
+        }
+        if (bytes[DSQuantilesLayout::FLAGS_BYTE] & DSQuantilesLayout::FLAG_EMPTY)
+        {
+            return size == DSQuantilesLayout::EMPTY_SIZE;
+        }
+
+        // An exact sketch holds n, min, max and then all items in its base buffer.
+        constexpr size_t items_start = DSQuantilesLayout::DATA_START + 2 * sizeof(T);
+        if (bytes[DSQuantilesLayout::PREAMBLE_LONGS_BYTE] != DSQuantilesLayout::PREAMBLE_LONGS_FULL ||
+            size < items_start)
+        {
+            return false;
+        }
+        const auto k = DSLoad<uint16_t>(bytes + DSQuantilesLayout::K_SHORT);
+        const auto n = DSLoad<uint64_t>(bytes + DSQuantilesLayout::N_LONG);
+        if (n >= 2 * static_cast<uint64_t>(k) || (size - items_start) % sizeof(T) != 0 ||
+            n != (size - items_start) / sizeof(T))
+        {
+            return false;
+        }
+        auto items = bytes + items_start;
+        for (uint64_t i = 0; i < n; i++)
+        {
+            sketch.update(DSLoad<T>(items + i * sizeof(T)));
+        }
+        return true;
+    }
+
+
+    // Layout of a serialized HLL sketch in HLL mode.
+    struct DSHLLLayout
+    {
+        static constexpr uint8_t FAMILY = 7;
+        static constexpr uint8_t SERIAL_VERSION = 1;
+        static constexpr uint8_t PREAMBLE_INTS_HLL = 10;
+        static constexpr uint8_t MIN_LG_K = 4;
+        static constexpr uint8_t MAX_LG_K = 21;
+
+        static constexpr uint8_t PREAMBLE_INTS_LIST = 2;
+        static constexpr uint8_t PREAMBLE_INTS_SET = 3;
+
+        static constexpr uint8_t MODE_LIST = 0;
+        static constexpr uint8_t MODE_SET = 1;
+        static constexpr uint8_t MODE_HLL = 2;
+        static constexpr uint8_t TYPE_HLL_4 = 0;
+        static constexpr uint8_t TYPE_HLL_6 = 1;
+        static constexpr uint8_t TYPE_HLL_8 = 2;
+
+        static constexpr uint8_t FLAG_EMPTY = 1 << 2;
+        static constexpr uint8_t FLAG_COMPACT = 1 << 3;
+        static constexpr uint8_t FLAG_OUT_OF_ORDER = 1 << 4;
+
+        static constexpr size_t PREAMBLE_INTS_BYTE = 0;
+        static constexpr size_t SERIAL_VERSION_BYTE = 1;
+        static constexpr size_t FAMILY_BYTE = 2;
+        static constexpr size_t LG_K_BYTE = 3;
+        static constexpr size_t FLAGS_BYTE = 5;
+        static constexpr size_t LIST_COUNT_BYTE = 6;
+        static constexpr size_t CUR_MIN_BYTE = 6;
+        static constexpr size_t MODE_BYTE = 7;
+        static constexpr size_t HASH_SET_COUNT_INT = 8;
+        static constexpr size_t HIP_ACCUM_DOUBLE = 8;
+        static constexpr size_t KXQ0_DOUBLE = 16;
+        static constexpr size_t KXQ1_DOUBLE = 24;
+        static constexpr size_t CUR_MIN_COUNT_INT = 32;
+        static constexpr size_t AUX_COUNT_INT = 36;
+        static constexpr size_t LIST_DATA_START = 8;
+        static constexpr size_t SET_DATA_START = 12;
+        static constexpr size_t DATA_START = 40;
+
+        // HLL_4 registers that overflow their nibble hold this token, their value is
+        // kept in the aux table as (value << 26) | slot.
+        static constexpr uint8_t AUX_TOKEN = 15;
+        static constexpr uint32_t AUX_SLOT_BITS = 26;
+        static constexpr uint32_t AUX_SLOT_MASK = (1u << AUX_SLOT_BITS) - 1;
+
+        static uint8_t Mode(const uint8_t *bytes) { return bytes[MODE_BYTE] & 3; }
+        static uint8_t Type(const uint8_t *bytes) { return (bytes[MODE_BYTE] >> 2) & 3; }
+    };
+
+    // Whether the bytes hold an HLL sketch in HLL mode, as opposed to the LIST and SET
+    // modes that small sketches use to store their coupons.
+    static inline bool DSHLLIsHLLMode(const char *data, size_t size)
+    {
+        auto bytes = reinterpret_cast<const uint8_t *>(data);
+        return size >= DSHLLLayout::DATA_START && bytes[DSHLLLayout::PREAMBLE_INTS_BYTE] == DSHLLLayout::PREAMBLE_INTS_HLL &&
+               bytes[DSHLLLayout::SERIAL_VERSION_BYTE] == DSHLLLayout::SERIAL_VERSION &&
+               bytes[DSHLLLayout::FAMILY_BYTE] == DSHLLLayout::FAMILY &&
+               bytes[DSHLLLayout::LG_K_BYTE] >= DSHLLLayout::MIN_LG_K &&
+               bytes[DSHLLLayout::LG_K_BYTE] <= DSHLLLayout::MAX_LG_K &&
+               !(bytes[DSHLLLayout::FLAGS_BYTE] & DSHLLLayout::FLAG_EMPTY) &&
+               DSHLLLayout::Mode(bytes) == DSHLLLayout::MODE_HLL;
+    }
+
+    // Whether the bytes after the preamble of an HLL sketch in HLL mode have the size
+    // of its registers and, for HLL_4, of an aux table.
+    static inline bool DSHLLHasRegisters(const uint8_t *bytes, size_t size)
+    {
+        const size_t k = size_t(1) << bytes[DSHLLLayout::LG_K_BYTE];
+        const size_t available = size - DSHLLLayout::DATA_START;
+        switch (DSHLLLayout::Type(bytes))
+        {
+        case DSHLLLayout::TYPE_HLL_8:
+            return available == k;
+        case DSHLLLayout::TYPE_HLL_6:
+            return available == k * 3 / 4 + 1;
+        case DSHLLLayout::TYPE_HLL_4:
+            return available >= k / 2 && (available - k / 2) % sizeof(uint32_t) == 0;
+        default:
+            return false;
+        }
+    }
+
+    struct DSHLLHeader
+    {
+        bool empty;
+        uint8_t lg_config_k;
+        bool compact;
+        bool has_estimate;
+        double estimate;
+    };
+
+    // Read the preamble of a serialized HLL sketch in any mode. A sketch in LIST or
+    // SET mode is empty without coupons, a sketch in HLL mode when all of its
+    // registers are still zero. compact tells the form the sketch was stored in, the
+    // deserialized sketch is always updatable.
+    //
+    // The estimate of a sketch in HLL mode whose registers were only ever raised by
+    // updates in order is its HIP accumulator, which is stored in the preamble and
+    // returned as is. Sketches that were merged are out of order, the library uses
+    // its composite estimator for them and interpolates over the coupons of the LIST
+    // and SET modes. Both depend on tables inside the library, so these sketches
+    // have no estimate here and are deserialized, like for the bounds.
+    static inline bool DSHLLReadHeader(const char *data, size_t size, DSHLLHeader &header)
+    {
+        auto bytes = reinterpret_cast<const uint8_t *>(data);
+        if (size < DSHLLLayout::LIST_DATA_START || bytes[DSHLLLayout::SERIAL_VERSION_BYTE] != DSHLLLayout::SERIAL_VERSION ||
+            bytes[DSHLLLayout::FAMILY_BYTE] != DSHLLLayout::FAMILY || bytes[DSHLLLayout::LG_K_BYTE] < DSHLLLayout::MIN_LG_K ||
+            bytes[DSHLLLayout::LG_K_BYTE] > DSHLLLayout::MAX_LG_K)
+        {
+            return false;
+        }
+        const auto flags = bytes[DSHLLLayout::FLAGS_BYTE];
+        header.lg_config_k = bytes[DSHLLLayout::LG_K_BYTE];
+        header.compact = flags & DSHLLLayout::FLAG_COMPACT;
+        header.has_estimate = false;
+
+        const auto preamble_ints = bytes[DSHLLLayout::PREAMBLE_INTS_BYTE];
+        switch (DSHLLLayout::Mode(bytes))
+        {
+        case DSHLLLayout::MODE_LIST:
+            header.empty = (flags & DSHLLLayout::FLAG_EMPTY) || bytes[DSHLLLayout::LIST_COUNT_BYTE] == 0;
+            return preamble_ints == DSHLLLayout::PREAMBLE_INTS_LIST;
+        case DSHLLLayout::MODE_SET:
+            if (preamble_ints != DSHLLLayout::PREAMBLE_INTS_SET || size < DSHLLLayout::SET_DATA_START)
+            {
+                return false;
+            }
+            header.empty = (flags & DSHLLLayout::FLAG_EMPTY) || DSLoad<uint32_t>(bytes + DSHLLLayout::HASH_SET_COUNT_INT) == 0;
+            return true;
+        case DSHLLLayout::MODE_HLL:
+            if (preamble_ints != DSHLLLayout::PREAMBLE_INTS_HLL || size < DSHLLLayout::DATA_START)
+            {
+                return false;
+            }
+            header.empty = bytes[DSHLLLayout::CUR_MIN_BYTE] == 0 &&
+                           DSLoad<uint32_t>(bytes + DSHLLLayout::CUR_MIN_COUNT_INT) == (uint32_t(1) << header.lg_config_k);
+            if (!(flags & (DSHLLLayout::FLAG_EMPTY | DSHLLLayout::FLAG_OUT_OF_ORDER)) && DSHLLHasRegisters(bytes, size))
+            {
+                header.has_estimate = true;
+                header.estimate = DSLoad<double>(bytes + DSHLLLayout::HIP_ACCUM_DOUBLE);
+            }
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    // Register-wise maximum of two arrays of 8-bit registers. The loops over the
+    // registers below are kept branch free so the compiler vectorizes them.
+    static inline void DSHLLMaxRegisters(uint8_t *__restrict target, const uint8_t *__restrict source, size_t count)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            target[i] = std::max(target[i], source[i]);
+        }
+    }
+
+    // Raise registers, which holds 1 << lg_k 8-bit registers, to the registers of a
+    // serialized HLL_4, HLL_6 or HLL_8 sketch in HLL mode with the same lg_k. Returns
+    // false, without touching the registers, for anything else.
+    static bool DSHLLMaxSerialized(uint8_t *__restrict registers, uint8_t lg_k, const char *data, size_t size)
+    {
+        if (!DSHLLIsHLLMode(data, size))
+        {
+            return false;
+        }
+        auto bytes = reinterpret_cast<const uint8_t *>(data);
+        if (bytes[DSHLLLayout::LG_K_BYTE] != lg_k)
+        {
+            return false;
+        }
+        const size_t k = size_t(1) << lg_k;
+        const uint8_t *__restrict source = bytes + DSHLLLayout::DATA_START;
+        const size_t available = size - DSHLLLayout::DATA_START;
+
+        switch (DSHLLLayout::Type(bytes))
+        {
+        case DSHLLLayout::TYPE_HLL_8:
+        {
+            if (available != k)
+            {
+                return false;
+            }
+            DSHLLMaxRegisters(registers, source, k);
+            return true;
+        }
+        case DSHLLLayout::TYPE_HLL_6:
+        {
+            // Four 6-bit registers are packed little endian into every three bytes.
+            if (available != k * 3 / 4 + 1)
+            {
+                return false;
+            }
+            for (size_t i = 0, j = 0; i < k; i += 4, j += 3)
+            {
+                const uint8_t b0 = source[j];
+                const uint8_t b1 = source[j + 1];
+                const uint8_t b2 = source[j + 2];
+                registers[i] = std::max(registers[i], static_cast<uint8_t>(b0 & 0x3f));
+                registers[i + 1] = std::max(registers[i + 1], static_cast<uint8_t>((b0 >> 6) | ((b1 & 0x0f) << 2)));
+                registers[i + 2] = std::max(registers[i + 2], static_cast<uint8_t>((b1 >> 4) | ((b2 & 0x03) << 4)));
+                registers[i + 3] = std::max(registers[i + 3], static_cast<uint8_t>(b2 >> 2));
+            }
+            return true;
+        }
+        case DSHLLLayout::TYPE_HLL_4:
+        {
+            // Two registers per byte, the odd slot in the high nibble, stored relative to
+            // cur_min and followed by the aux table, which is either compact or the
+            // updatable hash table with zeroes for its free entries.
+            const size_t register_bytes = k / 2;
+            if (available < register_bytes || (available - register_bytes) % sizeof(uint32_t) != 0)
+            {
+                return false;
+            }
+            auto aux = source + register_bytes;
+            const size_t aux_entries = (available - register_bytes) / sizeof(uint32_t);
+            for (size_t i = 0; i < aux_entries; i++)
+            {
+                const auto pair = DSLoad<uint32_t>(aux + i * sizeof(uint32_t));
+                if (pair != 0 && (pair & DSHLLLayout::AUX_SLOT_MASK) >= k)
+                {
+                    return false;
+                }
+            }
+
+            const uint8_t cur_min = bytes[DSHLLLayout::CUR_MIN_BYTE];
+            for (size_t j = 0; j < register_bytes; j++)
+            {
+                const uint8_t lo = source[j] & 0x0f;
+                const uint8_t hi = source[j] >> 4;
+                const uint8_t lo_value = lo == DSHLLLayout::AUX_TOKEN ? 0 : static_cast<uint8_t>(lo + cur_min);
+                const uint8_t hi_value = hi == DSHLLLayout::AUX_TOKEN ? 0 : static_cast<uint8_t>(hi + cur_min);
+                registers[2 * j] = std::max(registers[2 * j], lo_value);
+                registers[2 * j + 1] = std::max(registers[2 * j + 1], hi_value);
+            }
+            for (size_t i = 0; i < aux_entries; i++)
+            {
+                const auto pair = DSLoad<uint32_t>(aux + i * sizeof(uint32_t));
+                if (pair != 0)
+                {
+                    const auto slot = pair & DSHLLLayout::AUX_SLOT_MASK;
+                    registers[slot] = std::max(registers[slot], static_cast<uint8_t>(pair >> DSHLLLayout::AUX_SLOT_BITS));
+                }
+            }
+            return true;
+        }
+        default:
+            return false;
+        }
+    }
+
+    // Serialize 1 << lg_k 8-bit registers as an HLL_8 sketch in HLL mode. The sketch is
+    // flagged out of order, so its estimate only derives from the registers.
+    static std::vector<uint8_t> DSHLL8Serialize(const uint8_t *registers, uint8_t lg_k)
+    {
+        const size_t k = size_t(1) << lg_k;
+        std::vector<uint8_t> bytes(DSHLLLayout::DATA_START + k, 0);
+        bytes[DSHLLLayout::PREAMBLE_INTS_BYTE] = DSHLLLayout::PREAMBLE_INTS_HLL;
+        bytes[DSHLLLayout::SERIAL_VERSION_BYTE] = DSHLLLayout::SERIAL_VERSION;
+        bytes[DSHLLLayout::FAMILY_BYTE] = DSHLLLayout::FAMILY;
+        bytes[DSHLLLayout::LG_K_BYTE] = lg_k;
+        bytes[DSHLLLayout::FLAGS_BYTE] = DSHLLLayout::FLAG_OUT_OF_ORDER;
+        bytes[DSHLLLayout::MODE_BYTE] = DSHLLLayout::MODE_HLL | (DSHLLLayout::TYPE_HLL_8 << 2);
+
+        uint32_t histogram[256] = {};
+        for (size_t i = 0; i < k; i++)
+        {
+            histogram[registers[i]]++;
+        }
+        double kxq0 = 0;
+        double kxq1 = 0;
+        for (int value = 0; value < 256; value++)
+        {
+            if (histogram[value])
+            {
+                (value < 32 ? kxq0 : kxq1) += histogram[value] * std::ldexp(1.0, -value);
+            }
+        }
+        const double hip_accum = 0;
+        const uint32_t cur_min_count = histogram[0];
+        const uint32_t aux_count = 0;
+        memcpy(bytes.data() + DSHLLLayout::HIP_ACCUM_DOUBLE, &hip_accum, sizeof(double));
+        memcpy(bytes.data() + DSHLLLayout::KXQ0_DOUBLE, &kxq0, sizeof(double));
+        memcpy(bytes.data() + DSHLLLayout::KXQ1_DOUBLE, &kxq1, sizeof(double));
+        memcpy(bytes.data() + DSHLLLayout::CUR_MIN_COUNT_INT, &cur_min_count, sizeof(uint32_t));
+        memcpy(bytes.data() + DSHLLLayout::AUX_COUNT_INT, &aux_count, sizeof(uint32_t));
+        memcpy(bytes.data() + DSHLLLayout::DATA_START, registers, k);
+        return bytes;
+    }
+
+    // Layout of the preamble of a serialized CPC sketch.
+    struct DSCPCLayout
+    {
+        static constexpr uint8_t FAMILY = 16;
+        static constexpr uint8_t SERIAL_VERSION = 1;
+        static constexpr uint8_t MIN_LG_K = 4;
+        static constexpr uint8_t MAX_LG_K = 26;
+        static constexpr uint16_t DEFAULT_SEED_HASH = 0x93cc;
+
+        static constexpr uint8_t FLAG_HAS_TABLE = 1 << 3;
+        static constexpr uint8_t FLAG_HAS_WINDOW = 1 << 4;
+
+        static constexpr size_t PREAMBLE_INTS_BYTE = 0;
+        static constexpr size_t SERIAL_VERSION_BYTE = 1;
+        static constexpr size_t FAMILY_BYTE = 2;
+        static constexpr size_t LG_K_BYTE = 3;
+        static constexpr size_t FLAGS_BYTE = 5;
+        static constexpr size_t SEED_HASH_SHORT = 6;
+        static constexpr size_t NUM_COUPONS_INT = 8;
+    };
+
+    struct DSCPCHeader
+    {
+        bool empty;
+    };
+
+    // Read the preamble of a serialized CPC sketch. A sketch without a table and a
+    // window holds no coupons, otherwise the number of coupons follows the first
+    // eight bytes.
+    static inline bool DSCPCReadHeader(const char *data, size_t size, DSCPCHeader &header)
+    {
+        auto bytes = reinterpret_cast<const uint8_t *>(data);
+        if (size < DSCPCLayout::NUM_COUPONS_INT || size < bytes[DSCPCLayout::PREAMBLE_INTS_BYTE] * sizeof(uint32_t) ||
+            bytes[DSCPCLayout::SERIAL_VERSION_BYTE] != DSCPCLayout::SERIAL_VERSION ||
+            bytes[DSCPCLayout::FAMILY_BYTE] != DSCPCLayout::FAMILY || bytes[DSCPCLayout::LG_K_BYTE] < DSCPCLayout::MIN_LG_K ||
+            bytes[DSCPCLayout::LG_K_BYTE] > DSCPCLayout::MAX_LG_K ||
+            DSLoad<uint16_t>(bytes + DSCPCLayout::SEED_HASH_SHORT) != DSCPCLayout::DEFAULT_SEED_HASH)
+        {
+            return false;
+        }
+        if (!(bytes[DSCPCLayout::FLAGS_BYTE] & (DSCPCLayout::FLAG_HAS_TABLE | DSCPCLayout::FLAG_HAS_WINDOW)))
+        {
+            header.empty = true;
+            return true;
+        }
+        if (size < DSCPCLayout::NUM_COUPONS_INT + sizeof(uint32_t))
+        {
+            return false;
+        }
+        header.empty = DSLoad<uint32_t>(bytes + DSCPCLayout::NUM_COUPONS_INT) == 0;
+        return true;
+    }
+
+}